@@ -1,271 +1,2671 @@
 #include "BigInt.h"
+#include "BigIntStats.h"
+#include "LimbKernels.h"
+#include "ThreadPool.h"
 #include <algorithm>
 #include <cctype>
 #include <cmath>
 #include <random>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include <chrono>
 #include <climits>
 
+namespace {
+
+using Limb = uint64_t;
+
+// 10^19 is the largest power of ten that fits in a limb, so decimal text is
+// converted in 19-digit chunks.
+const Limb DECIMAL_CHUNK_BASE = 10000000000000000000ULL;
+const size_t DECIMAL_CHUNK_DIGITS = 19;
+
+inline int countLeadingZeros(Limb x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return x == 0 ? 64 : __builtin_clzll(x);
+#else
+    int n = 0;
+    if (x == 0) return 64;
+    while (!(x & (Limb(1) << 63))) {
+        x <<= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+inline int countTrailingZeros(Limb x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return x == 0 ? 64 : __builtin_ctzll(x);
+#else
+    int n = 0;
+    if (x == 0) return 64;
+    while (!(x & 1)) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+inline int popcount64(Limb x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    int n = 0;
+    for (; x != 0; x &= x - 1) {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// a + b + carry, with carry (0 or 1) updated in place.
+inline Limb addCarry(Limb a, Limb b, Limb& carry) {
+    Limb sum = a + carry;
+    Limb overflow = sum < carry;
+    sum += b;
+    carry = overflow + (sum < b);
+    return sum;
+}
+
+// a - b - borrow, with borrow (0 or 1) updated in place.
+inline Limb subBorrow(Limb a, Limb b, Limb& borrow) {
+    Limb diff = a - b;
+    Limb underflow = a < b;
+    underflow += diff < borrow;
+    diff -= borrow;
+    borrow = underflow;
+    return diff;
+}
+
+// Low limb of a * b + addend + carry; the high limb is returned in carry.
+// The full result always fits in 128 bits.
+inline Limb mulAddCarry(Limb a, Limb b, Limb addend, Limb& carry) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 t = static_cast<unsigned __int128>(a) * b + addend + carry;
+    carry = static_cast<Limb>(t >> 64);
+    return static_cast<Limb>(t);
+#else
+    const Limb mask = 0xFFFFFFFFULL;
+    Limb a0 = a & mask, a1 = a >> 32;
+    Limb b0 = b & mask, b1 = b >> 32;
+    Limb p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    Limb mid = (p00 >> 32) + (p01 & mask) + (p10 & mask);
+    Limb lo = (p00 & mask) | (mid << 32);
+    Limb hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+    lo += addend;
+    hi += lo < addend;
+    lo += carry;
+    hi += lo < carry;
+    carry = hi;
+    return lo;
+#endif
+}
+
+// (hi:lo) / d for hi < d; the remainder is returned in rem.
+inline Limb divWide(Limb hi, Limb lo, Limb d, Limb& rem) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 n = (static_cast<unsigned __int128>(hi) << 64) | lo;
+    rem = static_cast<Limb>(n % d);
+    return static_cast<Limb>(n / d);
+#else
+    // Two-step schoolbook division on 32-bit halves (Hacker's Delight, divlu).
+    const Limb b = 1ULL << 32;
+    int s = countLeadingZeros(d);
+    d <<= s;
+    Limb vn1 = d >> 32, vn0 = d & 0xFFFFFFFFULL;
+    Limb un32 = s == 0 ? hi : (hi << s) | (lo >> (64 - s));
+    Limb un10 = lo << s;
+    Limb un1 = un10 >> 32, un0 = un10 & 0xFFFFFFFFULL;
+
+    Limb q1 = un32 / vn1;
+    Limb rhat = un32 - q1 * vn1;
+    while (q1 >= b || q1 * vn0 > b * rhat + un1) {
+        --q1;
+        rhat += vn1;
+        if (rhat >= b) break;
+    }
+    Limb un21 = un32 * b + un1 - q1 * d;
+
+    Limb q0 = un21 / vn1;
+    rhat = un21 - q0 * vn1;
+    while (q0 >= b || q0 * vn0 > b * rhat + un0) {
+        --q0;
+        rhat += vn1;
+        if (rhat >= b) break;
+    }
+    rem = (un21 * b + un0 - q0 * d) >> s;
+    return q1 * b + q0;
+#endif
+}
+
+// floor((B^2 - 1) / d) - B for a normalized d (top bit set), B = 2^64.
+inline Limb reciprocalLimb(Limb d) {
+    Limb rem = 0;
+    return divWide(~d, ~Limb(0), d, rem);
+}
+
+// (u1:u0) / d for normalized d and u1 < d, using the precomputed reciprocal
+// v = reciprocalLimb(d) in place of a hardware division (Moller & Granlund,
+// "Improved division by invariant integers", Algorithm 4).
+inline Limb divWidePreinv(Limb u1, Limb u0, Limb d, Limb v, Limb& rem) {
+    Limb q1 = 0;
+    Limb q0 = mulAddCarry(v, u1, u0, q1);
+    q1 += u1 + 1;
+    Limb r = u0 - q1 * d;
+    if (r > q0) {
+        --q1;
+        r += d;
+    }
+    if (r >= d) {
+        ++q1;
+        r -= d;
+    }
+    rem = r;
+    return q1;
+}
+
+// q[0..n) = a[0..n) / d, returning the remainder. q may alias a.
+Limb divideBySingleLimb(Limb* q, const Limb* a, size_t n, Limb d) {
+    int shift = countLeadingZeros(d);
+    Limb normalized = d << shift;
+    Limb v = reciprocalLimb(normalized);
+    
+    // Feed the dividend through the same shift on the fly.
+    Limb rem = shift ? a[n - 1] >> (64 - shift) : 0;
+    for (size_t i = n; i-- > 0;) {
+        Limb u0 = a[i] << shift;
+        if (shift && i > 0) {
+            u0 |= a[i - 1] >> (64 - shift);
+        }
+        q[i] = divWidePreinv(rem, u0, normalized, v, rem);
+    }
+    return rem >> shift;
+}
+
+typedef LimbVector Limbs;
+
+// mag = mag * factor + addend
+void mulAddSmall(Limbs& mag, Limb factor, Limb addend) {
+    Limb carry = addend;
+    for (Limb& limb : mag) {
+        limb = mulAddCarry(limb, factor, 0, carry);
+    }
+    if (carry) {
+        mag.push_back(carry);
+    }
+}
+
+// mag = mag / divisor, returning the remainder. Leading zero limbs are trimmed.
+Limb divModSmall(Limbs& mag, Limb divisor) {
+    if (mag.empty()) {
+        return 0;
+    }
+    Limb rem = divideBySingleLimb(mag.data(), mag.data(), mag.size(), divisor);
+    while (!mag.empty() && mag.back() == 0) {
+        mag.pop_back();
+    }
+    return rem;
+}
+
+// The Karatsuba crossover depends on how fast the active kernels run the
+// basecase.
+BigInt::MultiplyThresholds initialThresholds() {
+    BigInt::MultiplyThresholds thresholds;
+    thresholds.karatsuba = LimbKernels::active().karatsubaThreshold;
+    return thresholds;
+}
+
+BigInt::MultiplyThresholds multiplyThresholds = initialThresholds();
+
+BigInt::ParallelPolicy parallelPolicy;
+
+typedef ThreadPool::TaskGroup TaskGroup;
+
+// Whether the pieces of work on operands of this many limbs run as
+// separate tasks: a TaskGroup built with false runs each one in place.
+bool splitAcrossThreads(size_t limbs) {
+    return parallelPolicy.threads > 1 && limbs >= parallelPolicy.minLimbs;
+}
+
+// Resource for the values a group's tasks assign their results to. Pool
+// threads allocate from the global heap, so while the group is parallel its
+// results land there and each move hands a buffer over, rather than copying
+// into the caller's resource from another thread. The values must be declared
+// before the group, so that they outlive its tasks even when the calling
+// thread's share of the work throws.
+std::pmr::memory_resource* taskResultResource(bool parallel) {
+    return parallel ? nullptr : LimbVector::currentResource();
+}
+
+void trimLimbs(Limbs& x) {
+    while (!x.empty() && x.back() == 0) {
+        x.pop_back();
+    }
+}
+
+int compareLimbs(const Limbs& a, const Limbs& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (size_t i = a.size(); i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// r[0..an) = a[0..an) + b[0..bn) for an >= bn, returning the carry out.
+Limb addLimbs(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    Limb carry = LimbKernels::active().add(r, a, b, bn);
+    for (size_t i = bn; i < an; ++i) {
+        r[i] = addCarry(a[i], 0, carry);
+    }
+    return carry;
+}
+
+// r[0..an) = a[0..an) - b[0..bn) for an >= bn, returning the borrow out.
+Limb subLimbs(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    Limb borrow = LimbKernels::active().subtract(r, a, b, bn);
+    for (size_t i = bn; i < an; ++i) {
+        r[i] = subBorrow(a[i], 0, borrow);
+    }
+    return borrow;
+}
+
+// r[0..rn) += a[0..an) for rn >= an, returning the carry out of r.
+Limb addInto(Limb* r, size_t rn, const Limb* a, size_t an) {
+    Limb carry = LimbKernels::active().add(r, r, a, an);
+    for (size_t i = an; carry && i < rn; ++i) {
+        r[i] = addCarry(r[i], 0, carry);
+    }
+    return carry;
+}
+
+// r[0..rn) -= a[0..an) for rn >= an, returning the borrow out of r.
+Limb subInto(Limb* r, size_t rn, const Limb* a, size_t an) {
+    Limb borrow = LimbKernels::active().subtract(r, r, a, an);
+    for (size_t i = an; borrow && i < rn; ++i) {
+        r[i] = subBorrow(r[i], 0, borrow);
+    }
+    return borrow;
+}
+
+void multiplyLimbs(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn);
+
+// r[0..an+bn) = a * b by the O(an * bn) basecase of the active kernels.
+void schoolbookMultiply(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    BIGINT_STATS_SCOPE(MultiplySchoolbook, an + bn);
+    LimbKernels::active().multiply(r, a, an, b, bn);
+}
+
+// r[0..2n) = a^2 by the basecase: each cross product a[i] * a[j] is formed
+// once and doubled, then the diagonal squares are added in.
+void schoolbookSquare(Limb* r, const Limb* a, size_t n) {
+    BIGINT_STATS_SCOPE(MultiplySchoolbook, 2 * n);
+    std::fill(r, r + 2 * n, 0);
+    const LimbKernels& kernels = LimbKernels::active();
+    for (size_t i = 0; i + 1 < n; ++i) {
+        r[i + n] = kernels.addMultiple(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+    }
+    
+    Limb shifted = 0;
+    for (size_t i = 0; i < 2 * n; ++i) {
+        Limb next = r[i] >> 63;
+        r[i] = (r[i] << 1) | shifted;
+        shifted = next;
+    }
+    
+    Limb carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        Limb high = 0;
+        Limb low = mulAddCarry(a[i], a[i], 0, high);
+        r[2 * i] = addCarry(r[2 * i], low, carry);
+        r[2 * i + 1] = addCarry(r[2 * i + 1], high, carry);
+    }
+}
+
+// Karatsuba for bn <= an < 2 * bn. With h = ceil(an / 2) and
+// a = a1 * X + a0, b = b1 * X + b0 (X = 2^(64h)):
+//   a * b = z2 * X^2 + ((a0 + a1)(b0 + b1) - z0 - z2) * X + z0
+void karatsubaMultiply(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    BIGINT_STATS_SCOPE(MultiplyKaratsuba, an + bn);
+    size_t h = (an + 1) / 2;
+    size_t total = an + bn;
+    
+    if (bn <= h) {
+        // b has no high half: a * b = a0 * b + a1 * b * X.
+        Limbs high(an - h + bn);
+        std::fill(r + h + bn, r + total, 0);
+        TaskGroup group(splitAcrossThreads(bn));
+        group.run([&] { multiplyLimbs(high.data(), a + h, an - h, b, bn); });
+        multiplyLimbs(r, a, h, b, bn);
+        group.wait();
+        addInto(r + h, total - h, high.data(), high.size());
+        return;
+    }
+    
+    size_t a1n = an - h;
+    size_t b1n = bn - h;
+    
+    // When squaring, passing the same sum twice keeps the recursion on the
+    // squaring path.
+    bool squaring = a == b && an == bn;
+    Limbs sa(h + 1), sb(squaring ? 0 : h + 1);
+    sa[h] = addLimbs(sa.data(), a, h, a + h, a1n);
+    if (!squaring) {
+        sb[h] = addLimbs(sb.data(), b, h, b + h, b1n);
+    }
+    const Limb* sbData = squaring ? sa.data() : sb.data();
+    
+    // The three products write disjoint buffers.
+    Limbs middle(2 * h + 2);
+    TaskGroup group(splitAcrossThreads(bn));
+    group.run([&] { multiplyLimbs(middle.data(), sa.data(), h + 1, sbData, h + 1); });
+    group.run([&] { multiplyLimbs(r + 2 * h, a + h, a1n, b + h, b1n); });
+    multiplyLimbs(r, a, h, b, h);
+    group.wait();
+    
+    subInto(middle.data(), middle.size(), r, 2 * h);
+    subInto(middle.data(), middle.size(), r + 2 * h, a1n + b1n);
+    trimLimbs(middle);
+    addInto(r + h, total - h, middle.data(), middle.size());
+}
+
+// Signed magnitude used for the Toom-3 evaluation points.
+struct SignedLimbs {
+    SignedLimbs() = default;
+    explicit SignedLimbs(std::pmr::memory_resource* resource) : mag(resource) {}
+    
+    Limbs mag;
+    bool negative = false;
+};
+
+SignedLimbs limbRange(const Limb* p, size_t n) {
+    SignedLimbs x;
+    x.mag.assign(p, p + n);
+    trimLimbs(x.mag);
+    return x;
+}
+
+SignedLimbs addSigned(const SignedLimbs& x, const SignedLimbs& y, bool negateY = false) {
+    bool yNegative = y.negative != negateY;
+    const Limbs& xm = x.mag;
+    const Limbs& ym = y.mag;
+    SignedLimbs result;
+    
+    if (x.negative == yNegative) {
+        const Limbs& longer = xm.size() >= ym.size() ? xm : ym;
+        const Limbs& shorter = xm.size() >= ym.size() ? ym : xm;
+        result.mag.resize(longer.size() + 1);
+        result.mag.back() = addLimbs(result.mag.data(), longer.data(), longer.size(),
+                                     shorter.data(), shorter.size());
+        result.negative = x.negative;
+    } else if (compareLimbs(xm, ym) >= 0) {
+        result.mag.resize(xm.size());
+        subLimbs(result.mag.data(), xm.data(), xm.size(), ym.data(), ym.size());
+        result.negative = x.negative;
+    } else {
+        result.mag.resize(ym.size());
+        subLimbs(result.mag.data(), ym.data(), ym.size(), xm.data(), xm.size());
+        result.negative = yNegative;
+    }
+    
+    trimLimbs(result.mag);
+    if (result.mag.empty()) {
+        result.negative = false;
+    }
+    return result;
+}
+
+SignedLimbs subSigned(const SignedLimbs& x, const SignedLimbs& y) {
+    return addSigned(x, y, true);
+}
+
+SignedLimbs multiplySigned(const SignedLimbs& x, const SignedLimbs& y) {
+    SignedLimbs result;
+    if (x.mag.empty() || y.mag.empty()) {
+        return result;
+    }
+    result.mag.resize(x.mag.size() + y.mag.size());
+    multiplyLimbs(result.mag.data(), x.mag.data(), x.mag.size(), y.mag.data(), y.mag.size());
+    trimLimbs(result.mag);
+    result.negative = x.negative != y.negative;
+    return result;
+}
+
+void shiftLeftOne(SignedLimbs& x) {
+    Limb carry = 0;
+    for (Limb& limb : x.mag) {
+        Limb next = limb >> 63;
+        limb = (limb << 1) | carry;
+        carry = next;
+    }
+    if (carry) {
+        x.mag.push_back(carry);
+    }
+}
+
+void shiftRightOne(SignedLimbs& x) {
+    for (size_t i = 0; i < x.mag.size(); ++i) {
+        Limb next = i + 1 < x.mag.size() ? x.mag[i + 1] : 0;
+        x.mag[i] = (x.mag[i] >> 1) | (next << 63);
+    }
+    trimLimbs(x.mag);
+}
+
+// Exact division by 3 via multiplication by its inverse modulo 2^64.
+void divideByThreeExact(SignedLimbs& x) {
+    const Limb inverseOfThree = 0xAAAAAAAAAAAAAAABULL;
+    Limb borrow = 0;
+    for (Limb& limb : x.mag) {
+        Limb value = limb - borrow;
+        Limb underflow = limb < borrow;
+        Limb q = value * inverseOfThree;
+        limb = q;
+        Limb high = 0;
+        mulAddCarry(q, 3, 0, high);
+        borrow = high + underflow;
+    }
+    trimLimbs(x.mag);
+}
+
+// Values of the three-piece polynomial p0 + p1 x + p2 x^2 at the Toom-3
+// points 0, 1, -1, -2 and infinity, with pieces of k limbs.
+void evaluateToom3(const Limb* p, size_t n, size_t k, SignedLimbs values[5]) {
+    SignedLimbs p0 = limbRange(p, k), p1 = limbRange(p + k, k), p2 = limbRange(p + 2 * k, n - 2 * k);
+    
+    // p(1) = p0 + p1 + p2, p(-1) = p0 - p1 + p2, p(-2) = 2(p(-1) + p2) - p0
+    SignedLimbs evenSum = addSigned(p0, p2);
+    values[1] = addSigned(evenSum, p1);
+    values[2] = subSigned(evenSum, p1);
+    values[3] = addSigned(values[2], p2);
+    shiftLeftOne(values[3]);
+    values[3] = subSigned(values[3], p0);
+    values[0] = p0;
+    values[4] = p2;
+}
+
+// Toom-3 for balanced operands, evaluating at 0, 1, -1, -2 and infinity and
+// interpolating with Bodrato's sequence. Requires bn > 2 * ceil(an / 3).
+void toom3Multiply(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    BIGINT_STATS_SCOPE(MultiplyToom3, an + bn);
+    size_t k = (an + 2) / 3;
+    size_t total = an + bn;
+    
+    SignedLimbs aValues[5], bValues[5];
+    evaluateToom3(a, an, k, aValues);
+    bool squaring = a == b && an == bn;
+    if (!squaring) {
+        evaluateToom3(b, bn, k, bValues);
+    }
+    const SignedLimbs* bPoints = squaring ? aValues : bValues;
+    
+    bool parallel = splitAcrossThreads(bn);
+    std::pmr::memory_resource* results = taskResultResource(parallel);
+    SignedLimbs r0, r1(results), rMinusOne(results), rMinusTwo(results), rInf(results);
+    TaskGroup group(parallel);
+    group.run([&] { r1 = multiplySigned(aValues[1], bPoints[1]); });
+    group.run([&] { rMinusOne = multiplySigned(aValues[2], bPoints[2]); });
+    group.run([&] { rMinusTwo = multiplySigned(aValues[3], bPoints[3]); });
+    group.run([&] { rInf = multiplySigned(aValues[4], bPoints[4]); });
+    r0 = multiplySigned(aValues[0], bPoints[0]);
+    group.wait();
+    
+    // Interpolation
+    SignedLimbs r3 = subSigned(rMinusTwo, r1);
+    divideByThreeExact(r3);
+    r1 = subSigned(r1, rMinusOne);
+    shiftRightOne(r1);
+    SignedLimbs r2 = subSigned(rMinusOne, r0);
+    r3 = subSigned(r2, r3);
+    shiftRightOne(r3);
+    SignedLimbs twiceInf = rInf;
+    shiftLeftOne(twiceInf);
+    r3 = addSigned(r3, twiceInf);
+    r2 = subSigned(addSigned(r2, r1), rInf);
+    r1 = subSigned(r1, r3);
+    
+    // Recomposition: every coefficient is non-negative and fits below the
+    // product, so the additions below never carry out of r.
+    std::fill(r, r + total, 0);
+    const SignedLimbs* coefficients[] = {&r0, &r1, &r2, &r3, &rInf};
+    for (size_t i = 0; i < 5; ++i) {
+        const Limbs& c = coefficients[i]->mag;
+        if (!c.empty()) {
+            addInto(r + i * k, total - i * k, c.data(), c.size());
+        }
+    }
+}
+
+// Arithmetic modulo a prime p < 2^62 in Montgomery form (R = 2^64).
+class NttField {
+public:
+    NttField(Limb modulus, Limb generator) : p(modulus), twoP(2 * modulus), g(generator) {
+        // Newton iteration for p^-1 mod 2^64; each step doubles the correct bits.
+        Limb inverse = p;
+        for (int i = 0; i < 6; ++i) {
+            inverse *= 2 - p * inverse;
+        }
+        negInverse = 0 - inverse;
+        
+        Limb rModP = (0 - p) % p;
+        rSquared = rModP;
+        for (int i = 0; i < 64; ++i) {
+            rSquared = add(rSquared, rSquared);
+        }
+    }
+    
+    Limb modulus() const { return p; }
+    
+    Limb add(Limb a, Limb b) const {
+        Limb sum = a + b;
+        return sum >= p ? sum - p : sum;
+    }
+    
+    // Written without branches: the comparison outcome is data dependent and
+    // mispredicts constantly inside the butterflies.
+    Limb sub(Limb a, Limb b) const {
+        return a - b + (p & (0 - static_cast<Limb>(a < b)));
+    }
+    
+    // a * b / R mod p
+    Limb mul(Limb a, Limb b) const {
+        Limb high = 0;
+        Limb low = mulAddCarry(a, b, 0, high);
+        Limb m = low * negInverse;
+        Limb mHigh = 0;
+        mulAddCarry(m, p, 0, mHigh);
+        // low + m * p is divisible by R and carries out exactly when low != 0.
+        Limb result = high + mHigh + (low != 0);
+        return result >= p ? result - p : result;
+    }
+    
+    // Butterfly variants on values kept in [0, 2p) (Harvey's lazy reduction);
+    // p < 2^62 leaves headroom for intermediate sums below 4p.
+    Limb addLazy(Limb a, Limb b) const {
+        Limb sum = a + b;
+        return sum - (twoP & (0 - static_cast<Limb>(sum >= twoP)));
+    }
+    
+    Limb subLazy(Limb a, Limb b) const {
+        Limb diff = a + twoP - b;
+        return diff - (twoP & (0 - static_cast<Limb>(diff >= twoP)));
+    }
+    
+    // a * b / R mod p in [0, 2p), for a < 4p and b < p.
+    Limb mulLazy(Limb a, Limb b) const {
+        Limb high = 0;
+        Limb low = mulAddCarry(a, b, 0, high);
+        Limb m = low * negInverse;
+        Limb mHigh = 0;
+        mulAddCarry(m, p, 0, mHigh);
+        return high + mHigh + (low != 0);
+    }
+    
+    Limb twiceModulus() const { return twoP; }
+    
+    // Any 64-bit value, reduced and moved into Montgomery form.
+    Limb toMontgomery(Limb x) const { return mul(x, rSquared); }
+    Limb fromMontgomery(Limb x) const { return mul(x, 1); }
+    
+    Limb pow(Limb base, Limb exponent) const {
+        Limb result = toMontgomery(1);
+        while (exponent) {
+            if (exponent & 1) result = mul(result, base);
+            base = mul(base, base);
+            exponent >>= 1;
+        }
+        return result;
+    }
+    
+    // Primitive n-th root of unity in Montgomery form; n divides p - 1.
+    Limb rootOfUnity(size_t n) const {
+        return pow(toMontgomery(g), (p - 1) / n);
+    }
+    
+    Limb inverse(Limb x) const { return pow(x, p - 2); }
+    
+private:
+    Limb p;
+    Limb twoP;
+    Limb g;
+    Limb negInverse;
+    Limb rSquared;
+};
+
+// Three primes c * 2^k + 1 below 2^62, each with 2^41 | p - 1, and a
+// primitive root of each. Their product exceeds 2^185, enough for exact
+// convolutions of 64-bit limbs up to 2^41 terms.
+const Limb NTT_PRIMES[3] = {4611615649683210241ULL, 4611613450659954689ULL, 4611549678985543681ULL};
+const Limb NTT_GENERATORS[3] = {11, 3, 19};
+const size_t NTT_MAX_LENGTH = size_t(1) << 41;
+
+// roots[half + j] = w^j for each power-of-two half < n, where w is a
+// primitive 2 * half-th root of unity (or its inverse).
+void computeNttRoots(std::vector<Limb>& roots, size_t n, const NttField& field, bool inverse) {
+    roots.assign(n, 0);
+    Limb root = field.rootOfUnity(n);
+    if (inverse) {
+        root = field.inverse(root);
+    }
+    for (size_t half = n / 2; half >= 1; half /= 2) {
+        Limb one = field.toMontgomery(1);
+        roots[half] = one;
+        for (size_t j = 1; j < half; ++j) {
+            roots[half + j] = field.mul(roots[half + j - 1], root);
+        }
+        root = field.mul(root, root);
+    }
+}
+
+// Decimation-in-frequency transform: natural order in, bit-reversed out.
+// Values stay in [0, 2p) throughout.
+void nttForward(Limb* a, size_t n, const std::vector<Limb>& roots, const NttField& sharedField) {
+    // A local copy lets the compiler keep the modulus in registers across
+    // the stores into a.
+    const NttField field = sharedField;
+    const Limb* w = roots.data();
+    for (size_t len = n; len >= 2; len /= 2) {
+        size_t half = len / 2;
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t j = 0; j < half; ++j) {
+                Limb u = a[i + j];
+                Limb v = a[i + j + half];
+                a[i + j] = field.addLazy(u, v);
+                a[i + j + half] = field.mulLazy(u + field.twiceModulus() - v, w[half + j]);
+            }
+        }
+    }
+}
+
+// Decimation-in-time inverse: bit-reversed in, natural order out, unscaled.
+// Values stay in [0, 2p) throughout.
+void nttInverse(Limb* a, size_t n, const std::vector<Limb>& roots, const NttField& sharedField) {
+    // A local copy lets the compiler keep the modulus in registers across
+    // the stores into a.
+    const NttField field = sharedField;
+    const Limb* w = roots.data();
+    for (size_t len = 2; len <= n; len *= 2) {
+        size_t half = len / 2;
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t j = 0; j < half; ++j) {
+                Limb u = a[i + j];
+                Limb v = field.mulLazy(a[i + j + half], w[half + j]);
+                a[i + j] = field.addLazy(u, v);
+                a[i + j + half] = field.subLazy(u, v);
+            }
+        }
+    }
+}
+
+// Cyclic convolution of a and b modulo one prime, left in plain form in out.
+void nttConvolve(std::vector<Limb>& out, const Limb* a, size_t an, const Limb* b, size_t bn,
+                 size_t n, const NttField& field) {
+    bool squaring = a == b && an == bn;
+    std::vector<Limb> roots;
+    computeNttRoots(roots, n, field, false);
+    
+    out.assign(n, 0);
+    for (size_t i = 0; i < an; ++i) {
+        out[i] = field.toMontgomery(a[i]);
+    }
+    nttForward(out.data(), n, roots, field);
+    
+    if (squaring) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = field.mul(out[i], out[i]);
+        }
+    } else {
+        std::vector<Limb> other(n, 0);
+        for (size_t i = 0; i < bn; ++i) {
+            other[i] = field.toMontgomery(b[i]);
+        }
+        nttForward(other.data(), n, roots, field);
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = field.mul(out[i], other[i]);
+        }
+    }
+    
+    computeNttRoots(roots, n, field, true);
+    nttInverse(out.data(), n, roots, field);
+    
+    // Multiplying a Montgomery value by the plain 1/n both rescales and
+    // leaves the plain result.
+    Limb scale = field.fromMontgomery(field.inverse(field.toMontgomery(n)));
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = field.mul(out[i], scale);
+    }
+}
+
+// Multi-prime NTT: convolve modulo three primes, then recover each exact
+// coefficient with Garner's CRT and propagate carries into r.
+void nttMultiply(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    BIGINT_STATS_SCOPE(MultiplyNtt, an + bn);
+    size_t total = an + bn;
+    size_t n = 1;
+    while (n < total - 1) {
+        n *= 2;
+    }
+    
+    const NttField f1(NTT_PRIMES[0], NTT_GENERATORS[0]);
+    const NttField f2(NTT_PRIMES[1], NTT_GENERATORS[1]);
+    const NttField f3(NTT_PRIMES[2], NTT_GENERATORS[2]);
+    const Limb p1 = f1.modulus(), p2 = f2.modulus(), p3 = f3.modulus();
+    
+    std::vector<Limb> c1, c2, c3;
+    TaskGroup group(splitAcrossThreads(std::min(an, bn)));
+    group.run([&] { nttConvolve(c2, a, an, b, bn, n, f2); });
+    group.run([&] { nttConvolve(c3, a, an, b, bn, n, f3); });
+    nttConvolve(c1, a, an, b, bn, n, f1);
+    group.wait();
+    
+    // Garner constants, in Montgomery form so that mul(plain, constant)
+    // yields a plain product.
+    const Limb p1ModP2 = p1 % p2, p1ModP3 = p1 % p3, p2ModP3 = p2 % p3;
+    const Limb inverseP1ModP2 = f2.inverse(f2.toMontgomery(p1ModP2));
+    const Limb p1ModP3Mont = f3.toMontgomery(p1ModP3);
+    const Limb p1p2ModP3 = f3.mul(p1ModP3, f3.toMontgomery(p2ModP3));
+    const Limb inverseP1P2ModP3 = f3.inverse(f3.toMontgomery(p1p2ModP3));
+    
+    Limb p1p2High = 0;
+    const Limb p1p2Low = mulAddCarry(p1, p2, 0, p1p2High);
+    
+    // Running three-limb accumulator for coefficient sums and carries.
+    Limb acc0 = 0, acc1 = 0, acc2 = 0;
+    for (size_t i = 0; i < total; ++i) {
+        if (i < total - 1) {
+            Limb v1 = c1[i];
+            Limb v2 = f2.mul(f2.sub(c2[i], v1 % p2), inverseP1ModP2);
+            Limb t = f3.sub(c3[i], v1 % p3);
+            t = f3.sub(t, f3.mul(v2 % p3, p1ModP3Mont));
+            Limb v3 = f3.mul(t, inverseP1P2ModP3);
+            
+            // x = v1 + v2 * p1 + v3 * p1 * p2
+            Limb x1 = 0;
+            Limb x0 = mulAddCarry(v2, p1, v1, x1);
+            Limb x2 = 0;
+            Limb y1 = 0;
+            Limb y0 = mulAddCarry(v3, p1p2Low, 0, y1);
+            y1 = mulAddCarry(v3, p1p2High, y1, x2);
+            Limb carry = 0;
+            x0 = addCarry(x0, y0, carry);
+            x1 = addCarry(x1, y1, carry);
+            x2 += carry;
+            
+            carry = 0;
+            acc0 = addCarry(acc0, x0, carry);
+            acc1 = addCarry(acc1, x1, carry);
+            acc2 = addCarry(acc2, x2, carry);
+        }
+        r[i] = acc0;
+        acc0 = acc1;
+        acc1 = acc2;
+        acc2 = 0;
+    }
+}
+
+// Splits a into bn-limb blocks so each block product is balanced.
+void unbalancedMultiply(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    size_t total = an + bn;
+    multiplyLimbs(r, a, bn, b, bn);
+    std::fill(r + 2 * bn, r + total, 0);
+    
+    Limbs partial(2 * bn);
+    for (size_t offset = bn; offset < an; offset += bn) {
+        size_t chunk = std::min(bn, an - offset);
+        multiplyLimbs(partial.data(), a + offset, chunk, b, bn);
+        addInto(r + offset, total - offset, partial.data(), chunk + bn);
+    }
+}
+
+void squareLimbs(Limb* r, const Limb* a, size_t n) {
+    if (n < multiplyThresholds.karatsuba) {
+        schoolbookSquare(r, a, n);
+    } else if (n < multiplyThresholds.toom3) {
+        karatsubaMultiply(r, a, n, a, n);
+    } else if (n < multiplyThresholds.ntt || 2 * n - 1 > NTT_MAX_LENGTH) {
+        toom3Multiply(r, a, n, a, n);
+    } else {
+        nttMultiply(r, a, n, a, n);
+    }
+}
+
+// r[0..an+bn) = a * b, choosing the algorithm by the smaller operand size.
+// Passing the same operand twice selects the squaring kernels. r must not
+// overlap either input.
+void multiplyLimbs(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    if (a == b && an == bn) {
+        squareLimbs(r, a, an);
+        return;
+    }
+    
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    
+    if (bn < multiplyThresholds.karatsuba) {
+        schoolbookMultiply(r, a, an, b, bn);
+    } else if (bn >= multiplyThresholds.ntt && an + bn - 1 <= NTT_MAX_LENGTH) {
+        // The transform length follows an + bn, so unbalanced operands are
+        // handled directly.
+        nttMultiply(r, a, an, b, bn);
+    } else if (an >= 2 * bn) {
+        unbalancedMultiply(r, a, an, b, bn);
+    } else if (bn >= multiplyThresholds.toom3 && bn > 2 * ((an + 2) / 3)) {
+        toom3Multiply(r, a, an, b, bn);
+    } else {
+        karatsubaMultiply(r, a, an, b, bn);
+    }
+}
+
+// Divisors of at least this many limbs, with a quotient at least as long,
+// are divided through a Newton reciprocal instead of Algorithm D.
+const size_t NEWTON_DIVISION_THRESHOLD = 1200;
+
+// Reciprocals of divisors up to this many limbs are computed exactly by
+// Algorithm D, ending the Newton recursion.
+const size_t NEWTON_RECIPROCAL_BASECASE = 32;
+
+Limbs multiplyVectors(const Limbs& a, const Limbs& b) {
+    Limbs result;
+    if (a.empty() || b.empty()) {
+        return result;
+    }
+    result.resize(a.size() + b.size());
+    multiplyLimbs(result.data(), a.data(), a.size(), b.data(), b.size());
+    trimLimbs(result);
+    return result;
+}
+
+// x -= y for x >= y.
+void subtractInPlace(Limbs& x, const Limbs& y) {
+    subInto(x.data(), x.size(), y.data(), y.size());
+    trimLimbs(x);
+}
+
+// x += y
+void addInPlace(Limbs& x, const Limbs& y) {
+    if (x.size() < y.size()) {
+        x.resize(y.size(), 0);
+    }
+    if (addInto(x.data(), x.size(), y.data(), y.size())) {
+        x.push_back(1);
+    }
+}
+
+void addSmallInPlace(Limbs& x, Limb value) {
+    Limbs small(1, value);
+    addInPlace(x, small);
+}
+
+void subtractSmallInPlace(Limbs& x, Limb value) {
+    subInto(x.data(), x.size(), &value, 1);
+    trimLimbs(x);
+}
+
+// x / B^count
+Limbs dropLowLimbs(const Limbs& x, size_t count) {
+    if (count >= x.size()) {
+        return Limbs();
+    }
+    return Limbs(x.begin() + count, x.end());
+}
+
+// r[0..n) = a[0..n) << shift for shift < 64, returning the bits shifted out.
+Limb shiftLeftBits(Limb* r, const Limb* a, size_t n, int shift) {
+    if (shift == 0) {
+        std::copy(a, a + n, r);
+        return 0;
+    }
+    Limb carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        Limb next = a[i] >> (64 - shift);
+        r[i] = (a[i] << shift) | carry;
+        carry = next;
+    }
+    return carry;
+}
+
+// r[0..n) = a[0..n) >> shift for shift < 64.
+void shiftRightBits(Limb* r, const Limb* a, size_t n, int shift) {
+    if (shift == 0) {
+        std::copy(a, a + n, r);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        Limb next = i + 1 < n ? a[i + 1] : 0;
+        r[i] = (a[i] >> shift) | (next << (64 - shift));
+    }
+}
+
+// r[0..n) -= a[0..n) * m, returning the high limb still to be subtracted.
+Limb subtractMultiple(Limb* r, const Limb* a, size_t n, Limb m) {
+    Limb carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        Limb product = mulAddCarry(a[i], m, 0, carry);
+        Limb borrow = 0;
+        r[i] = subBorrow(r[i], product, borrow);
+        carry += borrow;
+    }
+    return carry;
+}
+
+// Per-thread normalized operands of knuthDivide, which never re-enters
+// itself, so repeated divisions do not allocate. Like the other scratch
+// buffers it lives on the global heap.
+thread_local Limbs divisionScratch(nullptr);
+
+// Knuth's Algorithm D (TAOCP 4.3.1) for a >= d and n = d.size() >= 2.
+void knuthDivide(const Limb* a, size_t m, const Limb* d, size_t n, Limbs& q, Limbs& r) {
+    BIGINT_STATS_SCOPE(DivideKnuth, m + n);
+    int shift = countLeadingZeros(d[n - 1]);
+    divisionScratch.resize(n + m + 1);
+    Limb* dn = divisionScratch.data();
+    Limb* un = dn + n;
+    shiftLeftBits(dn, d, n, shift);
+    un[m] = shiftLeftBits(un, a, m, shift);
+    
+    const Limb dTop = dn[n - 1];
+    const Limb dNext = dn[n - 2];
+    const Limb v = reciprocalLimb(dTop);
+    
+    q.assign(m - n + 1, 0);
+    for (size_t j = m - n + 1; j-- > 0;) {
+        // Estimate the quotient limb from the top two limbs of the current
+        // remainder, then refine it with the next divisor limb.
+        Limb qhat, rhat;
+        bool rhatOverflow = false;
+        if (un[j + n] >= dTop) {
+            qhat = ~Limb(0);
+            rhat = un[j + n - 1] + dTop;
+            rhatOverflow = rhat < dTop;
+        } else {
+            qhat = divWidePreinv(un[j + n], un[j + n - 1], dTop, v, rhat);
+        }
+        while (!rhatOverflow) {
+            Limb productHigh = 0;
+            Limb productLow = mulAddCarry(qhat, dNext, 0, productHigh);
+            if (productHigh < rhat || (productHigh == rhat && productLow <= un[j + n - 2])) {
+                break;
+            }
+            --qhat;
+            rhat += dTop;
+            rhatOverflow = rhat < dTop;
+        }
+        
+        Limb borrow = subtractMultiple(un + j, dn, n, qhat);
+        Limb top = un[j + n];
+        un[j + n] = top - borrow;
+        if (top < borrow) {
+            // qhat was one too large; add the divisor back.
+            --qhat;
+            un[j + n] += addLimbs(un + j, un + j, n, dn, n);
+        }
+        q[j] = qhat;
+    }
+    
+    r.resize(n);
+    shiftRightBits(r.data(), un, n, shift);
+    trimLimbs(q);
+    trimLimbs(r);
+}
+
+// Approximation to B^(2n) / d for normalized d (top bit set) of n limbs,
+// within a few units of the true value. Each level solves the top half of
+// the divisor and applies one Newton step,
+//   x' = x + x * (B^(2n) - d * x) / B^(2n),
+// which doubles the number of correct limbs.
+Limbs newtonReciprocal(const Limb* d, size_t n) {
+    if (n <= NEWTON_RECIPROCAL_BASECASE) {
+        Limbs numerator(2 * n + 1, 0), q, r;
+        numerator[2 * n] = 1;
+        knuthDivide(numerator.data(), numerator.size(), d, n, q, r);
+        return q;
+    }
+    
+    // One guard limb beyond half keeps the truncation error to a few units.
+    size_t h = n / 2 + 1;
+    size_t low = n - h;
+    Limbs xh = newtonReciprocal(d + low, h);
+    
+    // With x = xh * B^low: d * x = (d * xh) * B^low.
+    Limbs dividend(d, d + n);
+    Limbs product = multiplyVectors(dividend, xh);
+    Limbs power(2 * n + 1 - low, 0);
+    power.back() = 1;
+    
+    Limbs x(low, 0);
+    x.insert(x.end(), xh.begin(), xh.end());
+    
+    // x * e / B^(2n) = xh * e / B^(2n - low)
+    if (compareLimbs(product, power) <= 0) {
+        subtractInPlace(power, product);
+        Limbs correction = dropLowLimbs(multiplyVectors(xh, power), 2 * n - 2 * low);
+        addInPlace(x, correction);
+    } else {
+        subtractInPlace(product, power);
+        Limbs correction = dropLowLimbs(multiplyVectors(xh, product), 2 * n - 2 * low);
+        subtractInPlace(x, correction);
+    }
+    return x;
+}
+
+// Division by a normalized reciprocal: the dividend is consumed in n-limb
+// blocks as in schoolbook division, and each 2n-by-n block quotient is
+// estimated from one multiplication by the reciprocal, then corrected.
+void newtonDivide(const Limbs& a, const Limbs& d, Limbs& q, Limbs& r) {
+    BIGINT_STATS_SCOPE(DivideNewton, a.size() + d.size());
+    size_t n = d.size();
+    int shift = countLeadingZeros(d.back());
+    Limbs dn(n), an(a.size() + 1);
+    shiftLeftBits(dn.data(), d.data(), n, shift);
+    an.back() = shiftLeftBits(an.data(), a.data(), a.size(), shift);
+    trimLimbs(an);
+    
+    Limbs x = newtonReciprocal(dn.data(), n);
+    
+    size_t m = an.size();
+    size_t blocks = (m + n - 1) / n;
+    q.assign(m, 0);
+    Limbs rem;
+    for (size_t block = blocks; block-- > 0;) {
+        size_t lo = block * n;
+        size_t hi = std::min(m, lo + n);
+        
+        // cur = rem * B^(hi - lo) + an[lo..hi), which is below dn * B^n.
+        Limbs cur(an.begin() + lo, an.begin() + hi);
+        cur.insert(cur.end(), rem.begin(), rem.end());
+        trimLimbs(cur);
+        
+        if (compareLimbs(cur, dn) < 0) {
+            rem = cur;
+            continue;
+        }
+        
+        // The low n - 1 limbs of cur change the estimate by less than one.
+        Limbs qhat = dropLowLimbs(multiplyVectors(dropLowLimbs(cur, n - 1), x), n + 1);
+        Limbs qd = multiplyVectors(qhat, dn);
+        while (compareLimbs(qd, cur) > 0) {
+            subtractSmallInPlace(qhat, 1);
+            subtractInPlace(qd, dn);
+        }
+        subtractInPlace(cur, qd);
+        while (compareLimbs(cur, dn) >= 0) {
+            addSmallInPlace(qhat, 1);
+            subtractInPlace(cur, dn);
+        }
+        
+        std::copy(qhat.begin(), qhat.end(), q.begin() + lo);
+        rem = cur;
+    }
+    
+    r.assign(rem.size(), 0);
+    if (!rem.empty()) {
+        shiftRightBits(r.data(), rem.data(), rem.size(), shift);
+    }
+    trimLimbs(q);
+    trimLimbs(r);
+}
+
+// q = a / d and r = a % d on magnitudes, for non-empty d. Either output may
+// be the same vector as a, but not d.
+void divideLimbs(const Limbs& a, const Limbs& d, Limbs& q, Limbs& r) {
+    if (compareLimbs(a, d) < 0) {
+        r = a;
+        q.clear();
+        return;
+    }
+    
+    if (d.size() == 1) {
+        BIGINT_STATS_SCOPE(DivideSingleLimb, a.size() + 1);
+        q.resize(a.size());
+        Limb rem = divideBySingleLimb(q.data(), a.data(), a.size(), d[0]);
+        trimLimbs(q);
+        r.assign(rem ? 1 : 0, rem);
+        return;
+    }
+    
+    if (d.size() >= NEWTON_DIVISION_THRESHOLD && a.size() - d.size() >= NEWTON_DIVISION_THRESHOLD) {
+        newtonDivide(a, d, q, r);
+    } else {
+        knuthDivide(a.data(), a.size(), d.data(), d.size(), q, r);
+    }
+}
+
+// Digit layout of a radix other than a power of two: chunkBase = base^chunkDigits
+// is the largest power of the base that fits in a limb.
+struct Radix {
+    Limb base;
+    Limb chunkBase;
+    size_t chunkDigits;
+};
+
+Radix radixFor(int base) {
+    Radix radix = {static_cast<Limb>(base), static_cast<Limb>(base), 1};
+    while (radix.chunkBase <= ~Limb(0) / radix.base) {
+        radix.chunkBase *= radix.base;
+        ++radix.chunkDigits;
+    }
+    return radix;
+}
+
+const Radix DECIMAL_RADIX = {10, DECIMAL_CHUNK_BASE, DECIMAL_CHUNK_DIGITS};
+
+// Conversions of up to this many chunks use the quadratic chunk loops;
+// longer ones are split at a cached power of the radix.
+const size_t RADIX_BASECASE_CHUNKS = 64;
+
+// No radix above 2 packs more than 40 digits into a chunk.
+const size_t MAX_CHUNK_DIGITS = 64;
+
+const char DIGIT_CHARACTERS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+// Value of a digit character in bases up to 36, or 36 if it is not one.
+inline Limb digitValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return static_cast<Limb>(c - '0');
+    }
+    if (c >= 'a' && c <= 'z') {
+        return static_cast<Limb>(c - 'a' + 10);
+    }
+    if (c >= 'A' && c <= 'Z') {
+        return static_cast<Limb>(c - 'A' + 10);
+    }
+    return 36;
+}
+
+// log2(base) for power-of-two bases, else 0.
+int radixBits(int base) {
+    if ((base & (base - 1)) != 0) {
+        return 0;
+    }
+    int bits = 0;
+    while ((1 << bits) < base) {
+        ++bits;
+    }
+    return bits;
+}
+
+// Levels of radixPower; level k covers 2^k chunks, far beyond any
+// addressable number of digits.
+const size_t RADIX_LEVELS = 64;
+
+// chunkBase^(2^k) for one radix, shared by every thread. Each level is
+// computed once, under the lock, and published through its atomic pointer,
+// so looking up a level that exists never blocks. The powers allocate from
+// the global heap and live as long as the process.
+struct RadixPowerTable {
+    std::atomic<const Limbs*> levels[RADIX_LEVELS];
+    std::mutex growth;
+};
+
+const Limbs& radixPower(const Radix& radix, size_t k) {
+    static RadixPowerTable tables[37];
+    RadixPowerTable& table = tables[radix.base];
+    if (const Limbs* power = table.levels[k].load(std::memory_order_acquire)) {
+        return *power;
+    }
+    
+    std::lock_guard<std::mutex> lock(table.growth);
+    for (size_t i = 0; i <= k; ++i) {
+        if (table.levels[i].load(std::memory_order_relaxed)) {
+            continue;
+        }
+        // Each level is the square of the previous one.
+        Limbs* power = new Limbs(nullptr);
+        if (i == 0) {
+            power->push_back(radix.chunkBase);
+        } else {
+            const Limbs& previous = *table.levels[i - 1].load(std::memory_order_relaxed);
+            power->resize(2 * previous.size());
+            multiplyLimbs(power->data(), previous.data(), previous.size(),
+                          previous.data(), previous.size());
+            trimLimbs(*power);
+        }
+        table.levels[i].store(power, std::memory_order_release);
+    }
+    return *table.levels[k].load(std::memory_order_relaxed);
+}
+
+// result = the digits [begin, end), each a valid digit of the radix. Long
+// inputs are split so that the low part has chunkDigits * 2^k digits, and
+// recombined as high * radixPower(k) + low. Short inputs are parsed straight
+// into result's existing storage.
+void parseDigits(const char* begin, const char* end, const Radix& radix, Limbs& result) {
+    size_t digitCount = static_cast<size_t>(end - begin);
+    if (digitCount <= radix.chunkDigits * RADIX_BASECASE_CHUNKS) {
+        result.clear();
+        result.reserve(digitCount / radix.chunkDigits + 1);
+        
+        size_t chunkLength = digitCount % radix.chunkDigits;
+        if (chunkLength == 0) {
+            chunkLength = radix.chunkDigits;
+        }
+        Limb chunkBase = 1;
+        for (size_t i = 0; i < chunkLength; ++i) {
+            chunkBase *= radix.base;
+        }
+        
+        for (const char* p = begin; p < end;) {
+            Limb chunk = 0;
+            for (const char* chunkEnd = p + chunkLength; p < chunkEnd; ++p) {
+                chunk = chunk * radix.base + digitValue(*p);
+            }
+            mulAddSmall(result, chunkBase, chunk);
+            chunkLength = radix.chunkDigits;
+            chunkBase = radix.chunkBase;
+        }
+        trimLimbs(result);
+        return;
+    }
+    
+    size_t k = 0;
+    while ((radix.chunkDigits << (k + 1)) < digitCount) {
+        ++k;
+    }
+    const char* split = end - (radix.chunkDigits << k);
+    bool parallel = splitAcrossThreads(digitCount / radix.chunkDigits);
+    Limbs high(taskResultResource(parallel)), low;
+    TaskGroup group(parallel);
+    group.run([&] { parseDigits(begin, split, radix, high); });
+    parseDigits(split, end, radix, low);
+    group.wait();
+    if (high.empty()) {
+        result.swap(low);
+        return;
+    }
+    
+    // high * B^n + low < (high + 1) * B^n, so no carry leaves the product.
+    const Limbs& power = radixPower(radix, k);
+    result.resize(high.size() + power.size());
+    multiplyLimbs(result.data(), high.data(), high.size(), power.data(), power.size());
+    addInto(result.data(), result.size(), low.data(), low.size());
+    trimLimbs(result);
+}
+
+// result = the digits [begin, end) of base 2^bits, packed straight into limbs.
+void parsePowerOfTwoDigits(const char* begin, const char* end, int bits, Limbs& result) {
+    size_t totalBits = static_cast<size_t>(end - begin) * bits;
+    result.assign((totalBits + 63) / 64, 0);
+    size_t bit = 0;
+    for (const char* p = end; p-- > begin; bit += bits) {
+        Limb value = digitValue(*p);
+        size_t offset = bit % 64;
+        result[bit / 64] |= value << offset;
+        if (offset + bits > 64) {
+            result[bit / 64 + 1] |= value >> (64 - offset);
+        }
+    }
+    trimLimbs(result);
+}
+
+// Per-thread copy of the value being peeled in writeDigits' basecase, so
+// short conversions do not allocate once it has grown.
+thread_local Limbs radixScratch(nullptr);
+
+// Writes the chunkDigits digits of chunk ending at end.
+template <Limb Base>
+void writeChunk(char* end, Limb chunk, size_t chunkDigits) {
+    for (size_t j = 1; j <= chunkDigits; ++j) {
+        end[-static_cast<std::ptrdiff_t>(j)] = DIGIT_CHARACTERS[chunk % Base];
+        chunk /= Base;
+    }
+}
+
+void writeChunk(char* end, Limb chunk, const Radix& radix) {
+    if (radix.base == 10) {
+        // A constant divisor lets the compiler avoid a hardware division.
+        writeChunk<10>(end, chunk, radix.chunkDigits);
+        return;
+    }
+    for (size_t j = 1; j <= radix.chunkDigits; ++j) {
+        end[-static_cast<std::ptrdiff_t>(j)] = DIGIT_CHARACTERS[chunk % radix.base];
+        chunk /= radix.base;
+    }
+}
+
+// Writes x < B^digits as exactly digits = chunkDigits * 2^k characters,
+// zero-padded on the left, by splitting x at radixPower(k - 1) until the
+// pieces reach the basecase.
+void writeDigits(const Limbs& x, char* out, const Radix& radix, size_t k) {
+    size_t digits = radix.chunkDigits << k;
+    if (x.empty()) {
+        std::fill(out, out + digits, '0');
+        return;
+    }
+    
+    if ((size_t(1) << k) <= RADIX_BASECASE_CHUNKS) {
+        Limbs& magnitude = radixScratch;
+        magnitude = x;
+        for (char* p = out + digits; p > out; p -= radix.chunkDigits) {
+            writeChunk(p, divModSmall(magnitude, radix.chunkBase), radix);
+        }
+        return;
+    }
+    
+    // The halves fill disjoint ends of the output.
+    Limbs q, r;
+    divideLimbs(x, radixPower(radix, k - 1), q, r);
+    TaskGroup group(splitAcrossThreads(x.size()));
+    group.run([&] { writeDigits(q, out, radix, k - 1); });
+    writeDigits(r, out + digits / 2, radix, k - 1);
+    group.wait();
+}
+
+// Smallest k with x < radixPower(k), so that x has at most chunkDigits * 2^k
+// digits.
+size_t radixLevel(const Limbs& x, const Radix& radix) {
+    size_t k = 0;
+    while (compareLimbs(x, radixPower(radix, k)) >= 0) {
+        ++k;
+    }
+    return k;
+}
+
+// Writes non-zero x without leading zeros into [first, last), returning the
+// end of the digits or null when they do not fit.
+char* writeDigitsTrimmed(const Limbs& x, const Radix& radix, char* first, char* last) {
+    size_t k = radixLevel(x, radix);
+    size_t digits = radix.chunkDigits << k;
+    if ((size_t(1) << k) <= RADIX_BASECASE_CHUNKS) {
+        char buffer[RADIX_BASECASE_CHUNKS * MAX_CHUNK_DIGITS];
+        writeDigits(x, buffer, radix, k);
+        const char* start = std::find_if(buffer, buffer + digits, [](char c) { return c != '0'; });
+        size_t length = static_cast<size_t>(buffer + digits - start);
+        if (length > static_cast<size_t>(last - first)) {
+            return nullptr;
+        }
+        return std::copy(start, static_cast<const char*>(buffer + digits), first);
+    }
+    
+    // Split across the pool, the full zero-padded width is written in two
+    // even halves when it fits, and the leading zeros shifted out after.
+    if (splitAcrossThreads(x.size()) && digits <= static_cast<size_t>(last - first)) {
+        writeDigits(x, first, radix, k);
+        char* start = std::find_if(first, first + digits, [](char c) { return c != '0'; });
+        if (start == first) {
+            return first + digits;
+        }
+        return std::copy(start, first + digits, first);
+    }
+    
+    // x >= radixPower(k - 1), so the high part is non-zero.
+    Limbs q, r;
+    divideLimbs(x, radixPower(radix, k - 1), q, r);
+    char* end = writeDigitsTrimmed(q, radix, first, last);
+    size_t half = radix.chunkDigits << (k - 1);
+    if (!end || half > static_cast<size_t>(last - end)) {
+        return nullptr;
+    }
+    writeDigits(r, end, radix, k - 1);
+    return end + half;
+}
+
+// Number of base-2^bits digits of non-zero x.
+size_t powerOfTwoDigitCount(const Limbs& x, int bits) {
+    size_t bitLength = x.size() * 64 - static_cast<size_t>(countLeadingZeros(x.back()));
+    return (bitLength + bits - 1) / bits;
+}
+
+// Writes non-zero x in base 2^bits into [first, last) by slicing its bits,
+// returning the end of the digits or null when they do not fit.
+char* writePowerOfTwoDigits(const Limbs& x, int bits, char* first, char* last) {
+    size_t digits = powerOfTwoDigitCount(x, bits);
+    if (digits > static_cast<size_t>(last - first)) {
+        return nullptr;
+    }
+    Limb mask = (Limb(1) << bits) - 1;
+    size_t bit = 0;
+    for (char* p = first + digits; p-- > first; bit += bits) {
+        size_t offset = bit % 64;
+        Limb value = x[bit / 64] >> offset;
+        if (offset + bits > 64 && bit / 64 + 1 < x.size()) {
+            value |= x[bit / 64 + 1] << (64 - offset);
+        }
+        *p = DIGIT_CHARACTERS[value & mask];
+    }
+    return first + digits;
+}
+
+// Upper bound on the characters needed for non-zero x in the given base.
+size_t digitCapacity(const Limbs& x, int base) {
+    int bits = radixBits(base);
+    if (bits) {
+        return powerOfTwoDigitCount(x, bits);
+    }
+    Radix radix = base == 10 ? DECIMAL_RADIX : radixFor(base);
+    return radix.chunkDigits << radixLevel(x, radix);
+}
+
+void checkBase(int base) {
+    if (base < 2 || base > 36) {
+        throw InvalidInputException("Base must be between 2 and 36");
+    }
+}
+
+// Parses the valid digits [first, last) of base into result.
+void parseMagnitude(const char* first, const char* last, int base, Limbs& result) {
+    BIGINT_STATS_SCOPE(Parse, 0);
+    if (int bits = radixBits(base)) {
+        parsePowerOfTwoDigits(first, last, bits, result);
+    } else {
+        parseDigits(first, last, base == 10 ? DECIMAL_RADIX : radixFor(base), result);
+    }
+    BIGINT_STATS_LIMBS(result.size());
+}
+
+// Writes non-zero x in base into [first, last), or returns null.
+char* writeMagnitude(const Limbs& x, int base, char* first, char* last) {
+    BIGINT_STATS_SCOPE(ToString, x.size());
+    if (int bits = radixBits(base)) {
+        return writePowerOfTwoDigits(x, bits, first, last);
+    }
+    return writeDigitsTrimmed(x, base == 10 ? DECIMAL_RADIX : radixFor(base), first, last);
+}
+
+// Scratch buffers live for the whole thread, so they always allocate from the
+// global heap rather than whatever resource is current at first use.
+
+// Per-thread buffer that operator*= multiplies into before swapping it with
+// the destination, so the destination's old storage is recycled next time.
+thread_local Limbs multiplyScratch(nullptr);
+
+// Per-thread quotient buffer for multiplyMod, whose quotient is discarded.
+thread_local Limbs quotientScratch(nullptr);
+
+// r[0..n) += a[0..n) * m, returning the carry limb.
+Limb addMultipleRow(Limb* r, const Limb* a, size_t n, Limb m) {
+    return LimbKernels::active().addMultiple(r, a, n, m);
+}
+
+// a = a * b in place by the basecase, for b not aliasing a. Rows are
+// accumulated from the top limb of a down, so each limb of a is read before
+// its position is overwritten.
+void multiplyInPlace(Limbs& a, const Limb* b, size_t bn) {
+    size_t an = a.size();
+    BIGINT_STATS_SCOPE(MultiplySchoolbook, an + bn);
+    a.resize(an + bn, 0);
+    for (size_t i = an; i-- > 0;) {
+        Limb ai = a[i];
+        a[i] = 0;
+        Limb carry = 0;
+        for (size_t j = 0; j < bn; ++j) {
+            a[i + j] = mulAddCarry(ai, b[j], a[i + j], carry);
+        }
+        Limb bit = 0;
+        a[i + bn] = addCarry(a[i + bn], carry, bit);
+        for (size_t k = i + bn + 1; bit; ++k) {
+            a[k] = addCarry(a[k], 0, bit);
+        }
+    }
+    trimLimbs(a);
+}
+
+// x = y - x for y >= x.
+void subtractFromInPlace(Limbs& x, const Limbs& y) {
+    x.resize(y.size(), 0);
+    Limb borrow = 0;
+    for (size_t i = 0; i < y.size(); ++i) {
+        x[i] = subBorrow(y[i], x[i], borrow);
+    }
+    trimLimbs(x);
+}
+
+void incrementLimbs(Limbs& x) {
+    for (Limb& limb : x) {
+        if (++limb != 0) {
+            return;
+        }
+    }
+    x.push_back(1);
+}
+
+// x -= 1 for non-zero x.
+void decrementLimbs(Limbs& x) {
+    for (Limb& limb : x) {
+        if (limb-- != 0) {
+            break;
+        }
+    }
+    trimLimbs(x);
+}
+
+// a[0..n) mod d, with divideBySingleLimb's preinverted steps and no quotient.
+Limb remainderBySingleLimb(const Limb* a, size_t n, Limb d) {
+    int shift = countLeadingZeros(d);
+    Limb normalized = d << shift;
+    Limb v = reciprocalLimb(normalized);
+    
+    Limb rem = shift ? a[n - 1] >> (64 - shift) : 0;
+    for (size_t i = n; i-- > 0;) {
+        Limb u0 = a[i] << shift;
+        if (shift && i > 0) {
+            u0 |= a[i - 1] >> (64 - shift);
+        }
+        divWidePreinv(rem, u0, normalized, v, rem);
+    }
+    return rem >> shift;
+}
+
+// x >> bits
+Limbs shiftRightLimbs(const Limbs& x, size_t bits) {
+    Limbs result = dropLowLimbs(x, bits / 64);
+    if (bits % 64 != 0 && !result.empty()) {
+        shiftRightBits(result.data(), result.data(), result.size(), static_cast<int>(bits % 64));
+        trimLimbs(result);
+    }
+    return result;
+}
+
+// x << bits
+Limbs shiftLeftLimbs(const Limbs& x, size_t bits) {
+    if (x.empty()) {
+        return Limbs();
+    }
+    Limbs result(bits / 64 + x.size() + 1, 0);
+    Limb* r = result.data() + bits / 64;
+    if (bits % 64 == 0) {
+        std::copy(x.begin(), x.end(), r);
+    } else {
+        r[x.size()] = shiftLeftBits(r, x.data(), x.size(), static_cast<int>(bits % 64));
+    }
+    trimLimbs(result);
+    return result;
+}
+
+size_t significantBits(const Limbs& x) {
+    return x.empty() ? 0 : x.size() * 64 - static_cast<size_t>(countLeadingZeros(x.back()));
+}
+
+// Two's complement bitwise operation on sign-magnitude operands, returning
+// the sign of the result. Bit for bit, a negative x is the complement of
+// |x| - 1 extended with ones, so each operand is taken as that magnitude
+// under an all-ones mask, and a negative result is mapped back the same way.
+template <typename Op>
+bool bitwiseLimbs(Limbs& r, const Limbs& a, bool aNegative, const Limbs& b, bool bNegative, Op op) {
+    Limbs aMinusOne, bMinusOne;
+    const Limbs* x = &a;
+    const Limbs* y = &b;
+    if (aNegative) {
+        aMinusOne = a;
+        decrementLimbs(aMinusOne);
+        x = &aMinusOne;
+    }
+    if (bNegative) {
+        bMinusOne = b;
+        decrementLimbs(bMinusOne);
+        y = &bMinusOne;
+    }
+    Limb xMask = aNegative ? ~Limb(0) : 0;
+    Limb yMask = bNegative ? ~Limb(0) : 0;
+    Limb rMask = op(xMask, yMask);
+    
+    size_t n = std::max(x->size(), y->size());
+    r.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        Limb xi = i < x->size() ? (*x)[i] : 0;
+        Limb yi = i < y->size() ? (*y)[i] : 0;
+        r[i] = op(xi ^ xMask, yi ^ yMask) ^ rMask;
+    }
+    trimLimbs(r);
+    if (rMask != 0) {
+        incrementLimbs(r);
+    }
+    return rMask != 0;
+}
+
+Limb isqrt64(Limb v) {
+    Limb r = static_cast<Limb>(std::sqrt(static_cast<double>(v)));
+    while (r > 0 && r > v / r) {
+        --r;
+    }
+    while (r + 1 <= v / (r + 1)) {
+        ++r;
+    }
+    return r;
+}
+
+// Number of trailing zero bits of a non-zero x.
+size_t trailingZeroBits(const Limbs& x) {
+    size_t i = 0;
+    while (x[i] == 0) {
+        ++i;
+    }
+    return 64 * i + static_cast<size_t>(countTrailingZeros(x[i]));
+}
+
+// Binary GCD: strip the common power of two, then subtract the smaller odd
+// value from the larger and drop the new trailing zeros until one vanishes.
+Limb gcd64(Limb a, Limb b) {
+    if (a == 0 || b == 0) {
+        return a | b;
+    }
+    int shift = countTrailingZeros(a | b);
+    a >>= countTrailingZeros(a);
+    do {
+        b >>= countTrailingZeros(b);
+        if (a > b) {
+            std::swap(a, b);
+        }
+        b -= a;
+    } while (b != 0);
+    return a << shift;
+}
+
+// Lehmer's GCD (TAOCP 4.5.2, Algorithm L). Euclid's quotients on multi-limb
+// x and y mostly depend on their leading bits only, so a run of them is
+// simulated on the top LEHMER_BITS bits in native arithmetic. The run stops
+// as soon as the quotient is not certain for every value x and y could be,
+// and its cofactors then advance x and y by many steps in one linear pass.
+const int LEHMER_BITS = 62;
+
+// (x, y) -> (a * x + b * y, c * x + d * y). Entries stay below
+// 2^LEHMER_BITS in magnitude, and a, b have opposite signs, as do c, d.
+struct LehmerMatrix {
+    int64_t a, b, c, d;
+};
+
+// Bits [shift, shift + LEHMER_BITS) of x.
+Limb leadingBits(const Limbs& x, size_t shift) {
+    size_t i = shift / 64;
+    int offset = static_cast<int>(shift % 64);
+    if (i >= x.size()) {
+        return 0;
+    }
+    Limb bits = x[i] >> offset;
+    if (offset != 0 && i + 1 < x.size()) {
+        bits |= x[i + 1] << (64 - offset);
+    }
+    return bits & ((Limb(1) << LEHMER_BITS) - 1);
+}
+
+// The cofactors of Euclid's steps on x >= y whose quotients the leading bits
+// determine. Returns false when not even the first one is certain, as when
+// y is far below x.
+bool lehmerMatrix(const Limbs& x, const Limbs& y, LehmerMatrix& m) {
+    size_t shift = significantBits(x) - LEHMER_BITS;
+    int64_t u = static_cast<int64_t>(leadingBits(x, shift));
+    int64_t v = static_cast<int64_t>(leadingBits(y, shift));
+    m = {1, 0, 0, 1};
+    // u + a and u + b bracket the true leading bits of x, and v + c, v + d
+    // those of y; a quotient is taken when both brackets agree on it.
+    while (v + m.c != 0 && v + m.d != 0) {
+        int64_t q = (u + m.a) / (v + m.c);
+        if (q != (u + m.b) / (v + m.d)) {
+            break;
+        }
+        int64_t t = m.a - q * m.c;
+        m.a = m.c;
+        m.c = t;
+        t = m.b - q * m.d;
+        m.b = m.d;
+        m.d = t;
+        t = u - q * v;
+        u = v;
+        v = t;
+    }
+    return m.b != 0;
+}
+
+// r = a * x + b * y for a matrix row, whose result is non-negative and at
+// most x.
+void combineLimbs(Limbs& r, const Limbs& x, int64_t a, const Limbs& y, int64_t b) {
+    const Limbs* plus = &x;
+    const Limbs* minus = &y;
+    Limb p = static_cast<Limb>(a);
+    Limb n = 0 - static_cast<Limb>(b);
+    if (a <= 0 && b >= 0) {
+        std::swap(plus, minus);
+        p = static_cast<Limb>(b);
+        n = 0 - static_cast<Limb>(a);
+    }
+    r.resize(x.size());
+    Limb carryPlus = 0, carryMinus = 0, borrow = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        Limb high = mulAddCarry(i < plus->size() ? (*plus)[i] : 0, p, 0, carryPlus);
+        Limb low = mulAddCarry(i < minus->size() ? (*minus)[i] : 0, n, 0, carryMinus);
+        r[i] = subBorrow(high, low, borrow);
+    }
+    trimLimbs(r);
+}
+
+// gcd(x, y) for x >= y, consuming both.
+Limbs gcdLimbs(Limbs& x, Limbs& y) {
+    Limbs q, nextX, nextY;
+    while (y.size() >= 2) {
+        LehmerMatrix m;
+        if (lehmerMatrix(x, y, m)) {
+            combineLimbs(nextX, x, m.a, y, m.b);
+            combineLimbs(nextY, x, m.c, y, m.d);
+            x.swap(nextX);
+            y.swap(nextY);
+        } else {
+            divideLimbs(x, y, q, nextY);
+            x.swap(y);
+            y.swap(nextY);
+        }
+    }
+    if (y.empty()) {
+        return std::move(x);
+    }
+    Limb g = gcd64(remainderBySingleLimb(x.data(), x.size(), y[0]), y[0]);
+    return Limbs(1, g);
+}
+
+// Odd primes below SMALL_PRIME_LIMIT, grouped into runs whose product fits
+// in a limb so that trial division costs one single-limb remainder of the
+// candidate per group.
+const Limb SMALL_PRIME_LIMIT = 4096;
+
+struct SmallPrimeTable {
+    struct Group {
+        Limb product;
+        size_t first;
+        size_t last;
+    };
+    std::vector<Limb> primes;
+    std::vector<Group> groups;
+};
+
+SmallPrimeTable buildSmallPrimeTable() {
+    SmallPrimeTable table;
+    std::vector<bool> composite(SMALL_PRIME_LIMIT, false);
+    for (Limb p = 3; p < SMALL_PRIME_LIMIT; p += 2) {
+        if (composite[p]) {
+            continue;
+        }
+        table.primes.push_back(p);
+        for (Limb q = p * p; q < SMALL_PRIME_LIMIT; q += 2 * p) {
+            composite[q] = true;
+        }
+    }
+    
+    size_t first = 0;
+    Limb product = 1;
+    for (size_t i = 0; i < table.primes.size(); ++i) {
+        Limb p = table.primes[i];
+        if (product > ~Limb(0) / p) {
+            table.groups.push_back({product, first, i});
+            first = i;
+            product = 1;
+        }
+        product *= p;
+    }
+    table.groups.push_back({product, first, table.primes.size()});
+    return table;
+}
+
+const SmallPrimeTable& smallPrimeTable() {
+    static const SmallPrimeTable table = buildSmallPrimeTable();
+    return table;
+}
+
+// Whether the odd number x has a prime factor below SMALL_PRIME_LIMIT other
+// than itself.
+bool hasSmallFactor(const Limbs& x) {
+    const SmallPrimeTable& table = smallPrimeTable();
+    bool single = x.size() == 1;
+    for (const SmallPrimeTable::Group& group : table.groups) {
+        Limb rem = remainderBySingleLimb(x.data(), x.size(), group.product);
+        for (size_t i = group.first; i < group.last; ++i) {
+            Limb p = table.primes[i];
+            if (rem % p == 0 && !(single && x[0] == p)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+inline Limb mulMod64(Limb a, Limb b, Limb m) {
+    Limb high = 0;
+    Limb low = mulAddCarry(a, b, 0, high);
+    Limb rem = 0;
+    divWide(high, low, m, rem);
+    return rem;
+}
+
+// Miller-Rabin round to base a for odd n > 2 in single-limb arithmetic.
+bool isStrongProbablePrime64(Limb n, Limb a) {
+    a %= n;
+    if (a == 0) {
+        return true;
+    }
+    Limb d = n - 1;
+    int s = 0;
+    while ((d & 1) == 0) {
+        d >>= 1;
+        ++s;
+    }
+    
+    Limb x = 1;
+    for (Limb base = a, e = d; e != 0; e >>= 1) {
+        if (e & 1) {
+            x = mulMod64(x, base, n);
+        }
+        base = mulMod64(base, base, n);
+    }
+    if (x == 1 || x == n - 1) {
+        return true;
+    }
+    for (int r = 1; r < s; ++r) {
+        x = mulMod64(x, x, n);
+        if (x == n - 1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// These seven bases leave no strong pseudoprime below 2^64 (Jim Sinclair's
+// set, verified against Feitsma's pseudoprime list).
+const Limb MILLER_RABIN_64_BASES[] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+
+// Jacobi symbol (a / m) for odd m.
+int jacobiSymbol(Limb a, Limb m) {
+    int result = 1;
+    a %= m;
+    while (a != 0) {
+        while ((a & 1) == 0) {
+            a >>= 1;
+            if ((m & 7) == 3 || (m & 7) == 5) {
+                result = -result;
+            }
+        }
+        std::swap(a, m);
+        if ((a & 3) == 3 && (m & 3) == 3) {
+            result = -result;
+        }
+        a %= m;
+    }
+    return m == 1 ? result : 0;
+}
+
+// Odd candidates per prime-search sieve window.
+const size_t PRIME_SIEVE_WINDOW = 4096;
+
+// Marks composite[i] for every candidate start + 2i (start odd) divisible
+// by a small prime other than itself.
+void sieveWindow(const Limbs& start, std::vector<unsigned char>& composite) {
+    const SmallPrimeTable& table = smallPrimeTable();
+    composite.assign(PRIME_SIEVE_WINDOW, 0);
+    bool single = start.size() == 1;
+    for (const SmallPrimeTable::Group& group : table.groups) {
+        Limb rem = remainderBySingleLimb(start.data(), start.size(), group.product);
+        for (size_t i = group.first; i < group.last; ++i) {
+            Limb p = table.primes[i];
+            // start + 2i = 0 mod p for i = -start / 2 mod p.
+            Limb first = (p - rem % p) % p * ((p + 1) / 2) % p;
+            if (single && start[0] + 2 * first == p) {
+                first += p;
+            }
+            for (size_t j = static_cast<size_t>(first); j < PRIME_SIEVE_WINDOW; j += p) {
+                composite[j] = 1;
+            }
+        }
+    }
+}
+
+// Lucas modular arithmetic on trimmed residues below m.
+void addModLimbs(Limbs& x, const Limbs& y, const Limbs& m) {
+    addInPlace(x, y);
+    if (compareLimbs(x, m) >= 0) {
+        subtractInPlace(x, m);
+    }
+}
+
+void subtractModLimbs(Limbs& x, const Limbs& y, const Limbs& m) {
+    if (compareLimbs(x, y) < 0) {
+        addInPlace(x, m);
+    }
+    subtractInPlace(x, y);
+}
+
+// x = x / 2 mod m for odd m.
+void halveModLimbs(Limbs& x, const Limbs& m) {
+    if (!x.empty() && (x[0] & 1)) {
+        addInPlace(x, m);
+    }
+    if (!x.empty()) {
+        shiftRightBits(x.data(), x.data(), x.size(), 1);
+        trimLimbs(x);
+    }
+}
+
+// Factorization
+// Trial division runs up to this bound, so smaller cofactors are prime.
+const Limb TRIAL_DIVISION_LIMIT = 1 << 16;
+
+// Gaps between consecutive numbers coprime to 2 * 3 * 5 * 7, from 1.
+const size_t WHEEL_SPOKES = 48;
+const Limb WHEEL_GAPS[WHEEL_SPOKES] = {10, 2, 4, 2, 4, 6, 2, 6, 4, 2, 4, 6, 6, 2, 6, 4,
+                                       2, 6, 4, 6, 8, 4, 2, 4, 2, 4, 8, 6, 4, 6, 2, 4,
+                                       6, 2, 6, 6, 4, 2, 4, 6, 2, 6, 4, 2, 4, 2, 10, 2};
+
+// Products of differences are accumulated this many steps between gcds.
+const size_t RHO_BATCH = 128;
+// Rho iterations spent on a multi-limb cofactor before moving on to ECM.
+const uint64_t RHO_ITERATION_BUDGET = uint64_t(1) << 18;
+
+// Brent's variant of Pollard's rho on x -> x^2 + c mod odd composite n,
+// the single limb of composite. Returns a divisor of n, which is n itself
+// when this seed fails.
+template <typename Checkpoint>
+Limb pollardBrent64(Limb n, Limb seed, Limb c, const BigInt& composite, Checkpoint& checkpoint) {
+    auto step = [n, c](Limb x) {
+        Limb y = mulMod64(x, x, n);
+        return y >= n - c ? y - (n - c) : y + c;
+    };
+    Limb y = seed, x = seed, ys = seed, q = 1, g = 1;
+    uint64_t iterations = 0;
+    for (uint64_t r = 1; g == 1; r *= 2) {
+        x = y;
+        for (uint64_t i = 0; i < r; ++i) {
+            y = step(y);
+        }
+        for (uint64_t k = 0; k < r && g == 1; k += RHO_BATCH) {
+            ys = y;
+            for (uint64_t i = 0; i < std::min<uint64_t>(RHO_BATCH, r - k); ++i) {
+                y = step(y);
+                q = mulMod64(q, x > y ? x - y : y - x, n);
+            }
+            g = gcd64(q, n);
+        }
+        iterations += 2 * r;
+        checkpoint(BigInt::FactorizationProgress::POLLARD_RHO, composite, iterations, 0);
+    }
+    if (g == n) {
+        // The batch overshot: replay it one gcd at a time.
+        do {
+            ys = step(ys);
+            g = gcd64(x > ys ? x - ys : ys - x, n);
+        } while (g == 1);
+    }
+    return g;
+}
+
+// The same walk in a ModContext's working representation, giving up with
+// zero after `budget` iterations or when the seed fails.
+template <typename Checkpoint>
+BigInt pollardBrent(const BigInt::ModContext& context, Limb seed, Limb c, uint64_t budget,
+                    Checkpoint& checkpoint) {
+    typedef BigInt::ModContext::Residue Residue;
+    const BigInt& n = context.modulus();
+    Residue y = context.toResidue(BigInt(static_cast<long long>(seed >> 1)));
+    Residue increment = context.toResidue(BigInt(static_cast<long long>(c >> 1)));
+    Residue x, ys, difference;
+    Residue q = context.toResidue(BigInt::ONE);
+    auto step = [&](Residue& v) {
+        context.multiply(v, v, v);
+        context.add(v, v, increment);
+    };
+    
+    BigInt g = BigInt::ONE;
+    uint64_t iterations = 0;
+    for (uint64_t r = 1; g == BigInt::ONE; r *= 2) {
+        if (iterations >= budget) {
+            return BigInt();
+        }
+        x = y;
+        for (uint64_t i = 0; i < r; ++i) {
+            step(y);
+        }
+        for (uint64_t k = 0; k < r && g == BigInt::ONE; k += RHO_BATCH) {
+            ys = y;
+            for (uint64_t i = 0; i < std::min<uint64_t>(RHO_BATCH, r - k); ++i) {
+                step(y);
+                context.subtract(difference, x, y);
+                context.multiply(q, q, difference);
+            }
+            g = BigInt::gcd(context.fromResidue(q), n);
+        }
+        iterations += 2 * r;
+        checkpoint(BigInt::FactorizationProgress::POLLARD_RHO, n, iterations, 0);
+    }
+    if (g == n) {
+        do {
+            step(ys);
+            context.subtract(difference, x, ys);
+            g = BigInt::gcd(context.fromResidue(difference), n);
+        } while (g == BigInt::ONE);
+    }
+    return g == n ? BigInt() : g;
+}
+
+// x-only arithmetic on a Montgomery curve B y^2 = x^3 + A x^2 + x over Z/nZ in
+// projective (X : Z) coordinates, with (A + 2) / 4 kept as a fraction so that
+// no inversion is needed (Montgomery, "Speeding the Pollard and elliptic
+// curve methods of factorization").
+class MontgomeryCurve {
+public:
+    typedef BigInt::ModContext::Residue Residue;
+    
+    struct Point {
+        Residue x;
+        Residue z;
+    };
+    
+    // Suyama's parametrization, giving group order divisible by 12, with
+    // its starting point.
+    MontgomeryCurve(const BigInt::ModContext& context, Limb sigma, Point& start)
+        : context(context) {
+        BigInt s(static_cast<long long>(sigma));
+        Residue u = context.toResidue(s * s - 5);
+        Residue v = context.toResidue(s * 4);
+        Residue t, w;
+        context.multiply(t, u, u);
+        context.multiply(start.x, t, u);       // u^3
+        context.multiply(t, v, v);
+        context.multiply(start.z, t, v);       // v^3
+        
+        context.subtract(w, v, u);
+        context.multiply(t, w, w);
+        context.multiply(t, t, w);             // (v - u)^3
+        context.add(w, u, u);
+        context.add(w, w, u);
+        context.add(w, w, v);                  // 3u + v
+        context.multiply(numerator, t, w);
+        context.multiply(t, start.x, v);       // u^3 v
+        Residue sixteen = context.toResidue(BigInt(16));
+        context.multiply(denominator, t, sixteen);
+    }
+    
+    // r = 2p; r may alias p.
+    void doublePoint(Point& r, const Point& p) {
+        context.add(t1, p.x, p.z);
+        context.multiply(t1, t1, t1);
+        context.subtract(t2, p.x, p.z);
+        context.multiply(t2, t2, t2);
+        context.subtract(t3, t1, t2);          // 4XZ
+        context.multiply(t1, t1, denominator);
+        context.multiply(r.x, t1, t2);
+        context.multiply(t2, t2, denominator);
+        context.multiply(t4, t3, numerator);
+        context.add(t2, t2, t4);
+        context.multiply(r.z, t3, t2);
+    }
+    
+    // r = p + q given difference = p - q; r may alias p or q.
+    void addPoints(Point& r, const Point& p, const Point& q, const Point& difference) {
+        context.subtract(t1, p.x, p.z);
+        context.add(t2, q.x, q.z);
+        context.multiply(t1, t1, t2);
+        context.add(t3, p.x, p.z);
+        context.subtract(t4, q.x, q.z);
+        context.multiply(t3, t3, t4);
+        context.add(t2, t1, t3);
+        context.subtract(t4, t1, t3);
+        context.multiply(t2, t2, t2);
+        context.multiply(t4, t4, t4);
+        context.multiply(r.x, difference.z, t2);
+        context.multiply(r.z, difference.x, t4);
+    }
+    
+    // r = [k] p for k >= 1 by the Montgomery ladder.
+    void multiplyPoint(Point& r, const Point& p, Limb k) {
+        Point low = p, high;
+        doublePoint(high, p);
+        for (int i = 62 - countLeadingZeros(k); i >= 0; --i) {
+            if ((k >> i) & 1) {
+                addPoints(low, high, low, p);
+                doublePoint(high, high);
+            } else {
+                addPoints(high, low, high, p);
+                doublePoint(low, low);
+            }
+        }
+        r = low;
+    }
+    
+private:
+    const BigInt::ModContext& context;
+    Residue numerator;
+    Residue denominator;
+    Residue t1, t2, t3, t4;
+};
+
+// Stage 1 bounds and the number of curves to run at each before moving up,
+// after GMP-ECM's table for factors of 20, 25, ... digits. The last bound is
+// used indefinitely.
+const struct {
+    Limb bound;
+    uint64_t curves;
+} ECM_SCHEDULE[] = {
+    {2000, 25}, {11000, 90}, {50000, 300}, {250000, 700},
+    {1000000, 1800}, {3000000, 5100}, {11000000, ~uint64_t(0)},
+};
+// Stage 2 runs to ECM_STAGE2_FACTOR times the stage 1 bound, in giant
+// steps of ECM_GIANT_STEP.
+const Limb ECM_STAGE2_FACTOR = 100;
+const Limb ECM_GIANT_STEP = 210;
+
+std::vector<Limb> primesUpTo(Limb limit) {
+    std::vector<bool> composite(limit + 1, false);
+    std::vector<Limb> primes;
+    for (Limb p = 2; p <= limit; ++p) {
+        if (composite[p]) {
+            continue;
+        }
+        primes.push_back(p);
+        for (Limb q = p * p; q <= limit; q += p) {
+            composite[q] = true;
+        }
+    }
+    return primes;
+}
+
+// One ECM curve with stage 1 to bound and the standard continuation with
+// baby steps j < ECM_GIANT_STEP / 2 coprime to it. Returns a proper divisor
+// of the modulus, or zero.
+BigInt ecmCurve(const BigInt::ModContext& context, Limb sigma, Limb bound,
+                const std::vector<Limb>& primes) {
+    typedef BigInt::ModContext::Residue Residue;
+    typedef MontgomeryCurve::Point Point;
+    const BigInt& n = context.modulus();
+    Point p;
+    MontgomeryCurve curve(context, sigma, p);
+    
+    // Stage 1: p = [k] p for k the product of the largest powers of the
+    // primes up to bound, folded into limb-sized multipliers.
+    Limb multiplier = 1;
+    for (Limb prime : primes) {
+        if (prime > bound) {
+            break;
+        }
+        Limb power = prime;
+        while (power <= bound / prime) {
+            power *= prime;
+        }
+        if (multiplier > ~Limb(0) / power) {
+            curve.multiplyPoint(p, p, multiplier);
+            multiplier = 1;
+        }
+        multiplier *= power;
+    }
+    curve.multiplyPoint(p, p, multiplier);
+    BigInt g = BigInt::gcd(context.fromResidue(p.z), n);
+    if (g == n) {
+        return BigInt();
+    }
+    if (g != BigInt::ONE) {
+        return g;
+    }
+    
+    // Stage 2: a prime q = kD +- j in (bound, ECM_STAGE2_FACTOR * bound] makes
+    // [kD] p and [j] p collide mod the factor, so X_kD Z_j - X_j Z_kD
+    // vanishes there.
+    const Limb half = ECM_GIANT_STEP / 2;
+    std::vector<Point> baby(half);
+    std::vector<Limb> steps;
+    baby[1] = p;
+    Point twice;
+    curve.doublePoint(twice, p);
+    curve.addPoints(baby[3], twice, p, p);
+    for (Limb j = 5; j < half; j += 2) {
+        curve.addPoints(baby[j], baby[j - 2], twice, baby[j - 4]);
+    }
+    for (Limb j = 1; j < half; j += 2) {
+        if (gcd64(j, ECM_GIANT_STEP) == 1) {
+            steps.push_back(j);
+        }
+    }
+    
+    Limb first = std::max<Limb>(2, bound / ECM_GIANT_STEP);
+    Point giant, previous, stride;
+    curve.multiplyPoint(stride, p, ECM_GIANT_STEP);
+    curve.multiplyPoint(previous, p, (first - 1) * ECM_GIANT_STEP);
+    curve.multiplyPoint(giant, p, first * ECM_GIANT_STEP);
+    Residue product = context.toResidue(BigInt::ONE);
+    Residue a, b;
+    for (Limb k = first; (k - 1) * ECM_GIANT_STEP <= ECM_STAGE2_FACTOR * bound; ++k) {
+        for (Limb j : steps) {
+            context.multiply(a, giant.x, baby[j].z);
+            context.multiply(b, baby[j].x, giant.z);
+            context.subtract(a, a, b);
+            context.multiply(product, product, a);
+        }
+        Point next;
+        curve.addPoints(next, giant, stride, previous);
+        previous = giant;
+        giant = next;
+    }
+    g = BigInt::gcd(context.fromResidue(product), n);
+    return g == n || g == BigInt::ONE ? BigInt() : g;
+}
+
+// A proper divisor of the odd composite m, which has no factor below
+// TRIAL_DIVISION_LIMIT and spans several limbs. Rho and ECM work modulo the
+// smallest prime factor, so prime powers are taken apart first by their
+// roots.
+template <typename Checkpoint>
+BigInt splitComposite(const BigInt& m, std::mt19937_64& rng, Checkpoint& checkpoint) {
+    BigInt root;
+    if (BigInt::isPerfectPower(m, &root)) {
+        return root;
+    }
+    
+    BigInt::ModContext context(m);
+    BigInt factor = pollardBrent(context, rng(), rng() | 2, RHO_ITERATION_BUDGET, checkpoint);
+    if (!factor.isZero()) {
+        return factor;
+    }
+    
+    uint64_t curves = 0;
+    for (const auto& level : ECM_SCHEDULE) {
+        std::vector<Limb> primes = primesUpTo(level.bound);
+        for (uint64_t i = 0; i < level.curves; ++i) {
+            checkpoint(BigInt::FactorizationProgress::ECM, m, curves, level.bound);
+            factor = ecmCurve(context, 6 + rng() % ((Limb(1) << 32) - 6), level.bound, primes);
+            ++curves;
+            if (!factor.isZero()) {
+                return factor;
+            }
+        }
+    }
+    return factor;
+}
+
+// Combinatorial products. factorial, binomial and catalan are assembled from
+// their prime factorizations, so the multiplications are few and balanced
+// instead of one growing accumulator times a small factor per step.
+
+// Products of this many limbs or fewer are accumulated linearly.
+const size_t PRODUCT_TREE_LEAF = 16;
+// Binomials with k up to this are computed as a running product and exact
+// quotient, without sieving primes up to n.
+const Limb BINOMIAL_DIRECT_LIMIT = 64;
+
+Limbs productRange(const Limb* factors, size_t n) {
+    if (n <= PRODUCT_TREE_LEAF) {
+        Limbs result(1, 1);
+        for (size_t i = 0; i < n; ++i) {
+            mulAddSmall(result, factors[i], 0);
+        }
+        return result;
+    }
+    size_t half = n / 2;
+    bool parallel = splitAcrossThreads(n);
+    Limbs low(taskResultResource(parallel));
+    TaskGroup group(parallel);
+    group.run([&] { low = productRange(factors, half); });
+    Limbs high = productRange(factors + half, n - half);
+    group.wait();
+    return multiplyVectors(low, high);
+}
+
+// Product of non-zero factors, packed into as few limbs as fit and then
+// multiplied as a balanced tree.
+Limbs productTree(std::vector<Limb>& factors) {
+    size_t packed = 0;
+    Limb current = 1;
+    for (Limb factor : factors) {
+        Limb high = 0;
+        Limb low = mulAddCarry(current, factor, 0, high);
+        if (high != 0) {
+            factors[packed++] = current;
+            current = factor;
+        } else {
+            current = low;
+        }
+    }
+    factors.resize(packed);
+    factors.push_back(current);
+    return productRange(factors.data(), factors.size());
+}
+
+// Product of p^exponent(p) over the primes p <= n.
+template <typename Exponent>
+Limbs primePowerProduct(const std::vector<Limb>& primes, Limb n, Exponent exponent) {
+    std::vector<Limb> factors;
+    for (size_t i = 0; i < primes.size() && primes[i] <= n; ++i) {
+        for (unsigned e = exponent(primes[i]); e > 0; --e) {
+            factors.push_back(primes[i]);
+        }
+    }
+    return productTree(factors);
+}
+
+// Luschny's prime swing: n! = (floor(n/2)!)^2 * swing(n), where an odd prime
+// p divides swing(n) once for every odd quotient floor(n / p^i), i >= 1. The
+// odd part of n! is therefore that of floor(n/2)! squared times the odd
+// part of swing(n); the powers of two are shifted in by the caller.
+Limbs oddFactorial(Limb n, const std::vector<Limb>& primes) {
+    if (n < 3) {
+        return Limbs(1, 1);
+    }
+    // n! has fewer than n * log2(n) bits; the half factorial and the swing
+    // are independent.
+    bool parallel = splitAcrossThreads(n * (64 - countLeadingZeros(n)) / 64);
+    Limbs half(taskResultResource(parallel));
+    TaskGroup group(parallel);
+    group.run([&] { half = oddFactorial(n / 2, primes); });
+    Limbs swing = primePowerProduct(primes, n, [n](Limb p) {
+        unsigned e = 0;
+        if (p == 2) {
+            return e;
+        }
+        for (Limb q = n / p; q > 0; q /= p) {
+            e += static_cast<unsigned>(q & 1);
+        }
+        return e;
+    });
+    group.wait();
+    return multiplyVectors(multiplyVectors(half, half), swing);
+}
+
+// Exponent of p in C(n, k): the borrows when k is subtracted from n in base
+// p (Kummer's theorem).
+unsigned binomialExponent(Limb n, Limb k, Limb p) {
+    unsigned e = 0;
+    Limb borrow = 0;
+    for (; n > 0; n /= p, k /= p) {
+        borrow = n % p < k % p + borrow;
+        e += static_cast<unsigned>(borrow);
+    }
+    return e;
+}
+
+// Sets (previous, current) = (F(n - 1), F(n)) for n >= 1 by fast doubling
+// over the bits of n below the top one. From F(k - 1) and F(k), two
+// squarings give F(2k - 1) = F(k)^2 + F(k - 1)^2 and
+// F(2k + 1) = 4F(k)^2 - F(k - 1)^2 + 2(-1)^k, and F(2k) is their difference.
+void fibonacciDoubling(Limb n, BigInt& previous, BigInt& current) {
+    previous = BigInt::ZERO;
+    current = BigInt::ONE;
+    BigInt low, high;
+    bool odd = true;
+    for (int bit = 62 - countLeadingZeros(n); bit >= 0; --bit) {
+        low = BigInt::square(previous);
+        high = BigInt::square(current);
+        previous = low + high;
+        high += high;
+        high += high;
+        high -= low;
+        high += odd ? -2 : 2;
+        odd = ((n >> bit) & 1) != 0;
+        if (odd) {
+            previous = high - previous;
+            current = std::move(high);
+        } else {
+            current = high - previous;
+        }
+    }
+}
+
+} // namespace
+
 // Static constants
 const BigInt BigInt::ZERO(0);
 const BigInt BigInt::ONE(1);
 const BigInt BigInt::TWO(2);
 
 // Constructors
-BigInt::BigInt() : digits({0}), negative(false) {}
+BigInt::BigInt() : negative(false) {}
 
 BigInt::BigInt(const std::string& str) : negative(false) {
-    if (str.empty()) {
+    assignDigits(str.data(), str.data() + str.length(), 10);
+}
+
+BigInt::BigInt(std::string_view str, int base) : negative(false) {
+    checkBase(base);
+    assignDigits(str.data(), str.data() + str.size(), base);
+}
+
+void BigInt::assignDigits(const char* first, const char* last, int base) {
+    if (first == last) {
         throw InvalidInputException("Empty string");
     }
     
-    size_t start = 0;
-    if (str[0] == '-') {
-        negative = true;
-        start = 1;
-    } else if (str[0] == '+') {
-        start = 1;
+    bool sign = false;
+    if (*first == '-') {
+        sign = true;
+        ++first;
+    } else if (*first == '+') {
+        ++first;
     }
     
-    if (start >= str.length()) {
+    if (first == last) {
         throw InvalidInputException("Invalid number format");
     }
     
-    digits.clear();
-    for (size_t i = str.length() - 1; i >= start; --i) {
-        if (!std::isdigit(str[i])) {
+    for (const char* p = first; p != last; ++p) {
+        if (digitValue(*p) >= static_cast<Limb>(base)) {
             throw InvalidInputException("Non-digit character in number");
         }
-        digits.push_back(str[i] - '0');
     }
     
+    parseMagnitude(first, last, base, limbs);
+    negative = sign;
     normalize();
 }
 
-BigInt::BigInt(long long num) : negative(false) {
-    if (num < 0) {
-        negative = true;
-        num = -num;
-    }
-    
-    if (num == 0) {
-        digits = {0};
-        return;
-    }
-    
-    digits.clear();
-    while (num > 0) {
-        digits.push_back(num % 10);
-        num /= 10;
+BigInt::BigInt(long long num) : negative(num < 0) {
+    // Negate in unsigned arithmetic so LLONG_MIN is handled.
+    Limb magnitude = negative ? 0 - static_cast<Limb>(num) : static_cast<Limb>(num);
+    if (magnitude != 0) {
+        limbs.push_back(magnitude);
     }
 }
 
-BigInt::BigInt(const BigInt& other) : digits(other.digits), negative(other.negative) {}
+BigInt::BigInt(const BigInt& other) : limbs(other.limbs), negative(other.negative) {}
 
 BigInt::BigInt(BigInt&& other) noexcept 
-    : digits(std::move(other.digits)), negative(other.negative) {
-    other.digits = {0};
+    : limbs(std::move(other.limbs)), negative(other.negative) {
+    other.limbs.clear();
     other.negative = false;
 }
 
 // Assignment operators
 BigInt& BigInt::operator=(const BigInt& other) {
     if (this != &other) {
-        digits = other.digits;
+        limbs = other.limbs;
         negative = other.negative;
     }
     return *this;
 }
 
-BigInt& BigInt::operator=(BigInt&& other) noexcept {
+BigInt& BigInt::operator=(BigInt&& other) {
     if (this != &other) {
-        digits = std::move(other.digits);
+        limbs = std::move(other.limbs);
         negative = other.negative;
-        other.digits = {0};
+        other.limbs.clear();
         other.negative = false;
     }
     return *this;
 }
 
 BigInt& BigInt::operator=(long long num) {
-    *this = BigInt(num);
+    negative = num < 0;
+    Limb magnitude = negative ? 0 - static_cast<Limb>(num) : static_cast<Limb>(num);
+    limbs.clear();
+    if (magnitude != 0) {
+        limbs.push_back(magnitude);
+    }
     return *this;
 }
 
 // Helper methods
 void BigInt::normalize() {
     removeLeadingZeros();
-    if (digits.size() == 1 && digits[0] == 0) {
+    if (limbs.empty()) {
         negative = false;
     }
 }
 
 void BigInt::removeLeadingZeros() {
-    while (digits.size() > 1 && digits.back() == 0) {
-        digits.pop_back();
+    while (!limbs.empty() && limbs.back() == 0) {
+        limbs.pop_back();
     }
 }
 
 int BigInt::compareMagnitude(const BigInt& other) const {
-    if (digits.size() != other.digits.size()) {
-        return digits.size() < other.digits.size() ? -1 : 1;
+    if (limbs.size() != other.limbs.size()) {
+        return limbs.size() < other.limbs.size() ? -1 : 1;
     }
     
-    for (int i = digits.size() - 1; i >= 0; --i) {
-        if (digits[i] != other.digits[i]) {
-            return digits[i] < other.digits[i] ? -1 : 1;
+    for (size_t i = limbs.size(); i-- > 0;) {
+        if (limbs[i] != other.limbs[i]) {
+            return limbs[i] < other.limbs[i] ? -1 : 1;
         }
     }
     return 0;
 }
-
-// Arithmetic operators
-BigInt BigInt::operator+(const BigInt& other) const {
-    if (negative != other.negative) {
-        if (negative) {
-            return other - (-*this);
-        } else {
-            return *this - (-other);
-        }
-    }
+
+BigInt BigInt::addMagnitude(const BigInt& a, const BigInt& b, bool negative) {
+    const Limbs& longer = a.limbs.size() >= b.limbs.size() ? a.limbs : b.limbs;
+    const Limbs& shorter = a.limbs.size() >= b.limbs.size() ? b.limbs : a.limbs;
     
     BigInt result;
+    result.limbs.resize(longer.size() + 1);
+    result.limbs.back() = addLimbs(result.limbs.data(), longer.data(), longer.size(),
+                                   shorter.data(), shorter.size());
     result.negative = negative;
-    result.digits.clear();
-    
-    int carry = 0;
-    size_t maxSize = std::max(digits.size(), other.digits.size());
-    
-    for (size_t i = 0; i < maxSize || carry; ++i) {
-        int sum = carry;
-        if (i < digits.size()) sum += digits[i];
-        if (i < other.digits.size()) sum += other.digits[i];
-        
-        result.digits.push_back(sum % 10);
-        carry = sum / 10;
-    }
-    
+    result.normalize();
     return result;
 }
 
-BigInt BigInt::operator-(const BigInt& other) const {
-    if (negative != other.negative) {
-        if (negative) {
-            return -((-*this) + other);
-        } else {
-            return *this + (-other);
-        }
-    }
-    
-    if (negative) {
-        return (-other) - (-*this);
+BigInt BigInt::subMagnitude(const BigInt& a, const BigInt& b, bool negative) {
+    int comparison = compareLimbs(a.limbs, b.limbs);
+    if (comparison == 0) {
+        return BigInt();
     }
     
-    if (*this < other) {
-        return -(other - *this);
-    }
+    const Limbs& larger = comparison > 0 ? a.limbs : b.limbs;
+    const Limbs& smaller = comparison > 0 ? b.limbs : a.limbs;
     
     BigInt result;
-    result.digits.clear();
-    
-    int borrow = 0;
-    for (size_t i = 0; i < digits.size(); ++i) {
-        int diff = digits[i] - borrow;
-        if (i < other.digits.size()) {
-            diff -= other.digits[i];
-        }
-        
-        if (diff < 0) {
-            diff += 10;
-            borrow = 1;
-        } else {
-            borrow = 0;
-        }
-        
-        result.digits.push_back(diff);
-    }
-    
+    result.limbs.resize(larger.size());
+    subLimbs(result.limbs.data(), larger.data(), larger.size(), smaller.data(), smaller.size());
+    result.negative = comparison > 0 ? negative : !negative;
     result.normalize();
     return result;
 }
 
+// Arithmetic operators
+BigInt BigInt::operator+(const BigInt& other) const {
+    BIGINT_STATS_SCOPE(Add, std::max(limbs.size(), other.limbs.size()));
+    if (negative == other.negative) {
+        return addMagnitude(*this, other, negative);
+    }
+    return subMagnitude(*this, other, negative);
+}
+
+BigInt BigInt::operator-(const BigInt& other) const {
+    BIGINT_STATS_SCOPE(Subtract, std::max(limbs.size(), other.limbs.size()));
+    if (negative != other.negative) {
+        return addMagnitude(*this, other, negative);
+    }
+    return subMagnitude(*this, other, negative);
+}
+
 BigInt BigInt::operator*(const BigInt& other) const {
+    BIGINT_STATS_SCOPE(Multiply, limbs.size() + other.limbs.size());
     if (isZero() || other.isZero()) {
         return ZERO;
     }
     
-    BigInt result = schoolbookMultiply(other);
+    BigInt result;
+    result.limbs.resize(limbs.size() + other.limbs.size());
+    multiplyLimbs(result.limbs.data(), limbs.data(), limbs.size(),
+                  other.limbs.data(), other.limbs.size());
     result.negative = negative != other.negative;
     result.normalize();
     return result;
 }
 
-BigInt BigInt::schoolbookMultiply(const BigInt& other) const {
-    BigInt result;
-    result.digits.resize(digits.size() + other.digits.size(), 0);
-    
-    for (size_t i = 0; i < digits.size(); ++i) {
-        int carry = 0;
-        for (size_t j = 0; j < other.digits.size() || carry; ++j) {
-            long long product = result.digits[i + j] + carry;
-            if (j < other.digits.size()) {
-                product += (long long)digits[i] * other.digits[j];
-            }
-            result.digits[i + j] = product % 10;
-            carry = product / 10;
-        }
+BigInt::MultiplyThresholds BigInt::getMultiplyThresholds() {
+    return multiplyThresholds;
+}
+
+void BigInt::setMultiplyThresholds(const MultiplyThresholds& thresholds) {
+    // Karatsuba below four limbs would recurse on operands of the same size.
+    if (thresholds.karatsuba < 4 || thresholds.toom3 < thresholds.karatsuba ||
+        thresholds.ntt < thresholds.toom3) {
+        throw InvalidInputException("Invalid multiplication thresholds");
     }
-    
-    result.normalize();
-    return result;
+    multiplyThresholds = thresholds;
 }
 
-BigInt BigInt::operator/(const BigInt& other) const {
-    if (other.isZero()) {
-        throw DivisionByZeroException();
+BigInt::ParallelPolicy BigInt::getParallelPolicy() {
+    return parallelPolicy;
+}
+
+void BigInt::setParallelPolicy(const ParallelPolicy& policy) {
+    ParallelPolicy resolved = policy;
+    if (resolved.threads == 0) {
+        resolved.threads = std::max(1u, std::thread::hardware_concurrency());
     }
-    
-    std::pair<BigInt, BigInt> result = divideWithRemainder(*this, other);
-    result.first.negative = negative != other.negative;
-    result.first.normalize();
-    return result.first;
+    ThreadPool::shared().resize(resolved.threads - 1);
+    parallelPolicy = resolved;
+}
+
+BigInt BigInt::operator/(const BigInt& other) const {
+    BigInt quotient, remainder;
+    divmod(*this, other, quotient, remainder);
+    return quotient;
 }
 
 BigInt BigInt::operator%(const BigInt& other) const {
-    if (other.isZero()) {
+    BigInt quotient, remainder;
+    divmod(*this, other, quotient, remainder);
+    return remainder;
+}
+
+std::pair<BigInt, BigInt> BigInt::divmod(const BigInt& dividend, const BigInt& divisor, DivisionMode mode) {
+    std::pair<BigInt, BigInt> result;
+    divmod(dividend, divisor, result.first, result.second, mode);
+    return result;
+}
+
+void BigInt::divmod(const BigInt& dividend, const BigInt& divisor,
+                    BigInt& quotient, BigInt& remainder, DivisionMode mode) {
+    BIGINT_STATS_SCOPE(Divide, dividend.limbs.size() + divisor.limbs.size());
+    if (divisor.isZero()) {
         throw DivisionByZeroException();
     }
+    if (&quotient == &remainder) {
+        throw InvalidInputException("Quotient and remainder must be different objects");
+    }
     
-    std::pair<BigInt, BigInt> result = divideWithRemainder(*this, other);
-    result.second.negative = negative;
-    result.second.normalize();
-    return result.second;
-}
-
-std::pair<BigInt, BigInt> BigInt::divideWithRemainder(const BigInt& dividend, const BigInt& divisor) {
-    if (dividend.isZero()) {
-        return {ZERO, ZERO};
+    // The kernels may overwrite the dividend as they go but still read the
+    // divisor after writing their outputs.
+    if (&quotient == &divisor || &remainder == &divisor) {
+        BigInt q, r;
+        divmod(dividend, divisor, q, r, mode);
+        quotient = std::move(q);
+        remainder = std::move(r);
+        return;
     }
     
-    BigInt quotient, remainder;
-    BigInt current = abs(dividend);
-    BigInt divisorAbs = abs(divisor);
+    bool dividendNegative = dividend.negative;
+    divideLimbs(dividend.limbs, divisor.limbs, quotient.limbs, remainder.limbs);
+    quotient.negative = dividendNegative != divisor.negative;
+    remainder.negative = dividendNegative;
+    quotient.normalize();
+    remainder.normalize();
     
-    for (int i = current.digits.size() - 1; i >= 0; --i) {
-        remainder.digits.insert(remainder.digits.begin(), current.digits[i]);
-        remainder.normalize();
-        
-        int digit = 0;
-        while (remainder >= divisorAbs) {
-            remainder = remainder - divisorAbs;
-            digit++;
-        }
-        
-        quotient.digits.insert(quotient.digits.begin(), digit);
+    if (remainder.isZero() || mode == DivisionMode::Truncate) {
+        return;
     }
     
-    quotient.normalize();
-    return {quotient, remainder};
+    // Truncation leaves the remainder with the dividend's sign; move one
+    // divisor across when the requested convention wants the other sign.
+    bool adjust = mode == DivisionMode::Floor ? remainder.negative != divisor.negative
+                                              : remainder.negative;
+    if (adjust) {
+        if (remainder.negative == divisor.negative) {
+            ++quotient;
+            remainder -= divisor;
+        } else {
+            --quotient;
+            remainder += divisor;
+        }
+    }
 }
 
 BigInt BigInt::operator^(const BigInt& other) const {
@@ -274,27 +2674,148 @@ BigInt BigInt::operator^(const BigInt& other) const {
 
 // Compound assignment operators
 BigInt& BigInt::operator+=(const BigInt& other) {
-    *this = *this + other;
+    BIGINT_STATS_SCOPE(Add, std::max(limbs.size(), other.limbs.size()));
+    if (negative == other.negative) {
+        addInPlace(limbs, other.limbs);
+    } else if (compareLimbs(limbs, other.limbs) >= 0) {
+        subtractInPlace(limbs, other.limbs);
+    } else {
+        subtractFromInPlace(limbs, other.limbs);
+        negative = other.negative;
+    }
+    normalize();
     return *this;
 }
 
 BigInt& BigInt::operator-=(const BigInt& other) {
-    *this = *this - other;
+    BIGINT_STATS_SCOPE(Subtract, std::max(limbs.size(), other.limbs.size()));
+    if (negative != other.negative) {
+        addInPlace(limbs, other.limbs);
+    } else if (compareLimbs(limbs, other.limbs) >= 0) {
+        subtractInPlace(limbs, other.limbs);
+    } else {
+        subtractFromInPlace(limbs, other.limbs);
+        negative = !negative;
+    }
+    normalize();
     return *this;
 }
 
 BigInt& BigInt::operator*=(const BigInt& other) {
-    *this = *this * other;
+    BIGINT_STATS_SCOPE(Multiply, limbs.size() + other.limbs.size());
+    if (isZero() || other.isZero()) {
+        clear();
+        return *this;
+    }
+    
+    negative = negative != other.negative;
+    size_t smaller = std::min(limbs.size(), other.limbs.size());
+    if (this != &other && smaller < multiplyThresholds.karatsuba) {
+        multiplyInPlace(limbs, other.limbs.data(), other.limbs.size());
+    } else {
+        multiplyScratch.resize(limbs.size() + other.limbs.size());
+        multiplyLimbs(multiplyScratch.data(), limbs.data(), limbs.size(),
+                      other.limbs.data(), other.limbs.size());
+        if (limbs.memoryResource() == multiplyScratch.memoryResource()) {
+            limbs.swap(multiplyScratch);
+        } else {
+            limbs = multiplyScratch;
+        }
+        normalize();
+    }
     return *this;
 }
 
+void BigInt::multiplyAdd(BigInt& accumulator, const BigInt& a, const BigInt& b) {
+    accumulateProduct(accumulator, a, b, a.negative != b.negative);
+}
+
+void BigInt::multiplySubtract(BigInt& accumulator, const BigInt& a, const BigInt& b) {
+    accumulateProduct(accumulator, a, b, a.negative == b.negative);
+}
+
+void BigInt::accumulateProduct(BigInt& accumulator, const BigInt& a, const BigInt& b,
+                               bool productNegative) {
+    BIGINT_STATS_SCOPE(Multiply, a.limbs.size() + b.limbs.size());
+    if (a.isZero() || b.isZero()) {
+        return;
+    }
+    
+    const Limbs& x = a.limbs;
+    const Limbs& y = b.limbs;
+    bool sameSign = accumulator.isZero() || accumulator.negative == productNegative;
+    bool aliased = &accumulator == &a || &accumulator == &b;
+    if (sameSign && !aliased && std::min(x.size(), y.size()) < multiplyThresholds.karatsuba) {
+        // The sum fits in one limb more than the wider of the two.
+        BIGINT_STATS_SCOPE(MultiplySchoolbook, x.size() + y.size());
+        Limbs& acc = accumulator.limbs;
+        acc.resize(std::max(acc.size(), x.size() + y.size()) + 1, 0);
+        for (size_t i = 0; i < x.size(); ++i) {
+            Limb carry = addMultipleRow(acc.data() + i, y.data(), y.size(), x[i]);
+            Limb bit = 0;
+            acc[i + y.size()] = addCarry(acc[i + y.size()], carry, bit);
+            for (size_t k = i + y.size() + 1; bit; ++k) {
+                acc[k] = addCarry(acc[k], 0, bit);
+            }
+        }
+        accumulator.negative = productNegative;
+        accumulator.normalize();
+        return;
+    }
+    
+    multiplyScratch.resize(x.size() + y.size());
+    multiplyLimbs(multiplyScratch.data(), x.data(), x.size(), y.data(), y.size());
+    trimLimbs(multiplyScratch);
+    if (sameSign) {
+        addInPlace(accumulator.limbs, multiplyScratch);
+        accumulator.negative = productNegative;
+    } else if (compareLimbs(accumulator.limbs, multiplyScratch) >= 0) {
+        subtractInPlace(accumulator.limbs, multiplyScratch);
+    } else {
+        subtractFromInPlace(accumulator.limbs, multiplyScratch);
+        accumulator.negative = productNegative;
+    }
+    accumulator.normalize();
+}
+
+void BigInt::multiplyMod(const BigInt& a, const BigInt& b, const BigInt& modulus,
+                         BigInt& result) {
+    if (modulus.isZero()) {
+        throw DivisionByZeroException();
+    }
+    
+    if (&result == &modulus) {
+        BigInt remainder;
+        multiplyMod(a, b, modulus, remainder);
+        result.limbs.swap(remainder.limbs);
+        result.negative = remainder.negative;
+        return;
+    }
+    
+    if (a.isZero() || b.isZero()) {
+        result.clear();
+        return;
+    }
+    
+    bool productNegative = a.negative != b.negative;
+    multiplyScratch.resize(a.limbs.size() + b.limbs.size());
+    multiplyLimbs(multiplyScratch.data(), a.limbs.data(), a.limbs.size(),
+                  b.limbs.data(), b.limbs.size());
+    trimLimbs(multiplyScratch);
+    divideLimbs(multiplyScratch, modulus.limbs, quotientScratch, result.limbs);
+    result.negative = productNegative;
+    result.normalize();
+}
+
 BigInt& BigInt::operator/=(const BigInt& other) {
-    *this = *this / other;
+    BigInt remainder;
+    divmod(*this, other, *this, remainder);
     return *this;
 }
 
 BigInt& BigInt::operator%=(const BigInt& other) {
-    *this = *this % other;
+    BigInt quotient;
+    divmod(*this, other, quotient, *this);
     return *this;
 }
 
@@ -303,9 +2824,98 @@ BigInt& BigInt::operator^=(const BigInt& other) {
     return *this;
 }
 
+// Native operand kernels
+void BigInt::addNative(uint64_t magnitude, bool negate) {
+    BIGINT_STATS_SCOPE(Add, limbs.size() + 1);
+    if (magnitude == 0) {
+        return;
+    }
+    if (isZero()) {
+        limbs.assign(1, magnitude);
+        negative = negate;
+    } else if (negative == negate) {
+        addSmallInPlace(limbs, magnitude);
+    } else if (limbs.size() > 1 || limbs[0] >= magnitude) {
+        subtractSmallInPlace(limbs, magnitude);
+        normalize();
+    } else {
+        limbs[0] = magnitude - limbs[0];
+        negative = negate;
+    }
+}
+
+void BigInt::multiplyNative(uint64_t magnitude, bool negate) {
+    BIGINT_STATS_SCOPE(Multiply, limbs.size() + 1);
+    if (magnitude == 0 || isZero()) {
+        limbs.clear();
+        negative = false;
+        return;
+    }
+    mulAddSmall(limbs, magnitude, 0);
+    negative = negative != negate;
+}
+
+uint64_t BigInt::divideNative(uint64_t magnitude, bool negate) {
+    BIGINT_STATS_SCOPE(Divide, limbs.size() + 1);
+    if (magnitude == 0) {
+        throw DivisionByZeroException();
+    }
+    uint64_t remainder = divModSmall(limbs, magnitude);
+    negative = negative != negate;
+    normalize();
+    return remainder;
+}
+
+void BigInt::remainderNative(uint64_t magnitude) {
+    BIGINT_STATS_SCOPE(Divide, limbs.size() + 1);
+    if (magnitude == 0) {
+        throw DivisionByZeroException();
+    }
+    if (isZero()) {
+        return;
+    }
+    uint64_t remainder = remainderBySingleLimb(limbs.data(), limbs.size(), magnitude);
+    limbs.assign(remainder ? 1 : 0, remainder);
+    normalize();
+}
+
+int64_t BigInt::divmodSmall(const BigInt& dividend, int64_t divisor, BigInt& quotient,
+                            DivisionMode mode) {
+    bool dividendNegative = dividend.isNegative();
+    if (&quotient != &dividend) {
+        quotient = dividend;
+    }
+    uint64_t magnitude = quotient.divideNative(nativeMagnitude(divisor), divisor < 0);
+    // |remainder| < |divisor| <= 2^63, so the negation cannot overflow.
+    int64_t remainder = dividendNegative ? -static_cast<int64_t>(magnitude)
+                                         : static_cast<int64_t>(magnitude);
+    if (remainder == 0 || mode == DivisionMode::Truncate) {
+        return remainder;
+    }
+    
+    // As in divmod: move one divisor across when the convention wants the
+    // remainder's other sign.
+    bool adjust = mode == DivisionMode::Floor ? (remainder < 0) != (divisor < 0) : remainder < 0;
+    if (adjust) {
+        if ((remainder < 0) == (divisor < 0)) {
+            ++quotient;
+            remainder -= divisor;
+        } else {
+            --quotient;
+            remainder += divisor;
+        }
+    }
+    return remainder;
+}
+
 // Increment/Decrement operators
 BigInt& BigInt::operator++() {
-    *this = *this + ONE;
+    if (negative) {
+        decrementLimbs(limbs);
+        normalize();
+    } else {
+        incrementLimbs(limbs);
+    }
     return *this;
 }
 
@@ -316,7 +2926,12 @@ BigInt BigInt::operator++(int) {
 }
 
 BigInt& BigInt::operator--() {
-    *this = *this - ONE;
+    if (negative || isZero()) {
+        incrementLimbs(limbs);
+        negative = true;
+    } else {
+        decrementLimbs(limbs);
+    }
     return *this;
 }
 
@@ -328,7 +2943,7 @@ BigInt BigInt::operator--(int) {
 
 // Comparison operators
 bool BigInt::operator==(const BigInt& other) const {
-    return negative == other.negative && digits == other.digits;
+    return negative == other.negative && limbs == other.limbs;
 }
 
 bool BigInt::operator!=(const BigInt& other) const {
@@ -362,7 +2977,7 @@ bool BigInt::operator>=(const BigInt& other) const {
 // Unary operators
 BigInt BigInt::operator-() const {
     BigInt result = *this;
-    result.negative = !negative;
+    result.negative = !negative && !isZero();
     return result;
 }
 
@@ -370,9 +2985,99 @@ BigInt BigInt::operator+() const {
     return *this;
 }
 
+// Bitwise operators
+BigInt BigInt::operator&(const BigInt& other) const {
+    BigInt result;
+    result.negative = bitwiseLimbs(result.limbs, limbs, isNegative(), other.limbs, other.isNegative(),
+                                   [](Limb x, Limb y) { return x & y; });
+    return result;
+}
+
+BigInt BigInt::operator|(const BigInt& other) const {
+    BigInt result;
+    result.negative = bitwiseLimbs(result.limbs, limbs, isNegative(), other.limbs, other.isNegative(),
+                                   [](Limb x, Limb y) { return x | y; });
+    return result;
+}
+
+BigInt BigInt::bitwiseXor(const BigInt& a, const BigInt& b) {
+    BigInt result;
+    result.negative = bitwiseLimbs(result.limbs, a.limbs, a.isNegative(), b.limbs, b.isNegative(),
+                                   [](Limb x, Limb y) { return x ^ y; });
+    return result;
+}
+
+BigInt BigInt::operator~() const {
+    BigInt result = -*this;
+    --result;
+    return result;
+}
+
+BigInt BigInt::operator<<(size_t bits) const {
+    BigInt result;
+    result.limbs = shiftLeftLimbs(limbs, bits);
+    result.negative = isNegative();
+    return result;
+}
+
+// Floor division by 2^bits: a negative x maps to -(((|x| - 1) >> bits) + 1).
+BigInt BigInt::operator>>(size_t bits) const {
+    BigInt result;
+    if (!isNegative()) {
+        result.limbs = shiftRightLimbs(limbs, bits);
+        return result;
+    }
+    Limbs minusOne = limbs;
+    decrementLimbs(minusOne);
+    result.limbs = shiftRightLimbs(minusOne, bits);
+    incrementLimbs(result.limbs);
+    result.negative = true;
+    return result;
+}
+
+BigInt& BigInt::operator&=(const BigInt& other) {
+    return *this = *this & other;
+}
+
+BigInt& BigInt::operator|=(const BigInt& other) {
+    return *this = *this | other;
+}
+
+BigInt& BigInt::operator<<=(size_t bits) {
+    return *this = *this << bits;
+}
+
+BigInt& BigInt::operator>>=(size_t bits) {
+    return *this = *this >> bits;
+}
+
+// Bit queries
+size_t BigInt::bitLength() const {
+    return significantBits(limbs);
+}
+
+// Bit i of a negative x is the complement of bit i of |x| - 1, which
+// differs from |x| only up to its lowest set bit.
+bool BigInt::testBit(size_t i) const {
+    bool bit = i / 64 < limbs.size() && ((limbs[i / 64] >> (i % 64)) & 1) != 0;
+    if (!isNegative()) {
+        return bit;
+    }
+    size_t lowest = trailingZeroBits(limbs);
+    return i < lowest ? false : i == lowest ? true : !bit;
+}
+
+size_t BigInt::popcount() const {
+    size_t count = 0;
+    for (Limb limb : limbs) {
+        count += static_cast<size_t>(popcount64(limb));
+    }
+    return count;
+}
+
 // Utility methods
 bool BigInt::isZero() const {
-    return digits.size() == 1 && digits[0] == 0;
+    return limbs.empty();
 }
 
 bool BigInt::isNegative() const {
@@ -384,37 +3089,51 @@ bool BigInt::isPositive() const {
 }
 
 int BigInt::getDigitCount() const {
-    return digits.size();
+    if (isZero()) {
+        return 1;
+    }
+    // 2^(b-1) <= |x| < 2^b puts the count within one of (b - 1) * log10(2) + 1.
+    // Shaving the estimate keeps rounding from pushing it past the count, so
+    // at most a step or two up remain.
+    const double LOG10_2 = 0.30102999566398119521;
+    double estimate = static_cast<double>(bitLength() - 1) * LOG10_2 * (1 - 1e-12);
+    long long digits = static_cast<long long>(estimate) + 1;
+    BigInt power = pow(BigInt(10), BigInt(digits));
+    while (compareLimbs(limbs, power.limbs) >= 0) {
+        power.multiplyNative(10, false);
+        ++digits;
+    }
+    return static_cast<int>(digits);
 }
 
-std::string BigInt::toString() const {
+std::string BigInt::toString(int base) const {
+    checkBase(base);
     if (isZero()) {
         return "0";
     }
     
-    std::string result;
-    if (negative) {
-        result += "-";
-    }
-    
-    for (int i = digits.size() - 1; i >= 0; --i) {
-        result += '0' + digits[i];
-    }
-    
+    // Size the string for the longest value of this many chunks, then trim.
+    size_t sign = negative ? 1 : 0;
+    std::string result(sign + digitCapacity(limbs, base), '0');
+    std::to_chars_result written = to_chars(&result[0], &result[0] + result.size(), *this, base);
+    result.resize(static_cast<size_t>(written.ptr - result.data()));
     return result;
 }
 
 long long BigInt::toLongLong() const {
-    if (*this > BigInt(LLONG_MAX) || *this < BigInt(LLONG_MIN)) {
-        throw OutOfRangeException("Value too large for long long");
+    if (isZero()) {
+        return 0;
     }
     
-    long long result = 0;
-    for (int i = digits.size() - 1; i >= 0; --i) {
-        result = result * 10 + digits[i];
+    const Limb limit = static_cast<Limb>(LLONG_MAX) + (negative ? 1 : 0);
+    if (limbs.size() > 1 || limbs[0] > limit) {
+        throw OutOfRangeException("Value too large for long long");
     }
     
-    return negative ? -result : result;
+    if (negative) {
+        return -static_cast<long long>(limbs[0] - 1) - 1;
+    }
+    return static_cast<long long>(limbs[0]);
 }
 
 // Mathematical functions
@@ -423,10 +3142,39 @@ BigInt BigInt::factorial(int n) {
         throw InvalidInputException("Factorial not defined for negative numbers");
     }
     
-    BigInt result(1);
-    for (int i = 2; i <= n; ++i) {
-        result *= BigInt(i);
+    Limb twos = 0;
+    for (Limb q = static_cast<Limb>(n) / 2; q > 0; q /= 2) {
+        twos += q;
     }
+    BigInt result;
+    result.limbs = shiftLeftLimbs(oddFactorial(static_cast<Limb>(n), primesUpTo(static_cast<Limb>(n))),
+                                  static_cast<size_t>(twos));
+    return result;
+}
+
+BigInt BigInt::binomial(int n, int k) {
+    if (n < 0) {
+        throw InvalidInputException("Binomial coefficients not defined for negative n");
+    }
+    if (k < 0 || k > n) {
+        return ZERO;
+    }
+    Limb top = static_cast<Limb>(n);
+    Limb bottom = static_cast<Limb>(std::min(k, n - k));
+    
+    BigInt result;
+    if (bottom <= BINOMIAL_DIRECT_LIMIT) {
+        // C(n - k + i, i) is an integer at every step.
+        result.limbs.assign(1, 1);
+        for (Limb i = 1; i <= bottom; ++i) {
+            mulAddSmall(result.limbs, top - bottom + i, 0);
+            divModSmall(result.limbs, i);
+        }
+        return result;
+    }
+    result.limbs = primePowerProduct(primesUpTo(top), top, [top, bottom](Limb p) {
+        return binomialExponent(top, bottom, p);
+    });
     return result;
 }
 
@@ -439,13 +3187,49 @@ BigInt BigInt::fibonacci(int n) {
         return BigInt(n);
     }
     
-    BigInt a(0), b(1);
-    for (int i = 2; i <= n; ++i) {
-        BigInt temp = a + b;
-        a = b;
-        b = temp;
+    // The last doubling step needs only one of F(2k) and F(2k + 1), each a
+    // single product: F(k) * (F(k) + 2F(k - 1)), and
+    // (2F(k) + F(k - 1)) * (2F(k) - F(k - 1)) + 2(-1)^k.
+    Limb k = static_cast<Limb>(n) / 2;
+    BigInt previous, current;
+    fibonacciDoubling(k, previous, current);
+    if (n % 2 == 0) {
+        return current * (current + previous + previous);
+    }
+    BigInt twice = current + current;
+    BigInt result = (twice + previous) * (twice - previous);
+    result += k % 2 == 0 ? 2 : -2;
+    return result;
+}
+
+std::pair<BigInt, BigInt> BigInt::fibonacciPair(int n) {
+    if (n < 0) {
+        throw InvalidInputException("Fibonacci not defined for negative numbers");
+    }
+    
+    if (n == 0) {
+        return {ZERO, ONE};
+    }
+    BigInt previous, current;
+    fibonacciDoubling(static_cast<Limb>(n), previous, current);
+    previous += current;
+    return {std::move(current), std::move(previous)};
+}
+
+BigInt BigInt::lucas(int n) {
+    if (n < 0) {
+        throw InvalidInputException("Lucas numbers not defined for negative numbers");
+    }
+    
+    if (n == 0) {
+        return TWO;
     }
-    return b;
+    // L(n) = F(n - 1) + F(n + 1) = 2F(n - 1) + F(n).
+    BigInt previous, current;
+    fibonacciDoubling(static_cast<Limb>(n), previous, current);
+    current += previous;
+    current += previous;
+    return current;
 }
 
 BigInt BigInt::catalan(int n) {
@@ -453,109 +3237,401 @@ BigInt BigInt::catalan(int n) {
         throw InvalidInputException("Catalan numbers not defined for negative numbers");
     }
     
-    BigInt numerator = factorial(2 * n);
-    BigInt denominator = factorial(n + 1) * factorial(n);
-    return numerator / denominator;
+    // C(2n, n) / (n + 1), with the division done on the exponents.
+    Limb m = static_cast<Limb>(n);
+    BigInt result;
+    result.limbs = primePowerProduct(primesUpTo(2 * m), 2 * m, [m](Limb p) {
+        unsigned e = binomialExponent(2 * m, m, p);
+        for (Limb q = m + 1; q % p == 0; q /= p) {
+            --e;
+        }
+        return e;
+    });
+    return result;
 }
 
 BigInt BigInt::gcd(const BigInt& a, const BigInt& b) {
-    BigInt x = abs(a);
-    BigInt y = abs(b);
+    BIGINT_STATS_SCOPE(Gcd, a.limbs.size() + b.limbs.size());
+    Limbs x = a.limbs;
+    Limbs y = b.limbs;
+    if (compareLimbs(x, y) < 0) {
+        x.swap(y);
+    }
+    BigInt result;
+    result.limbs = gcdLimbs(x, y);
+    return result;
+}
+
+// Lehmer's algorithm again, also carrying the cofactor s of |a| through each
+// step: x = s * |a| + t * |b| for the current remainder x. t follows from the
+// identity at the end, after s is reduced to its smallest representative.
+BigInt BigInt::extendedGcd(const BigInt& a, const BigInt& b, BigInt& x, BigInt& y) {
+    BIGINT_STATS_SCOPE(Gcd, a.limbs.size() + b.limbs.size());
+    bool swapped = compareLimbs(a.limbs, b.limbs) < 0;
+    const BigInt& larger = swapped ? b : a;
+    const BigInt& smaller = swapped ? a : b;
+    
+    BigInt r0 = abs(larger), r1 = abs(smaller);
+    BigInt s0(1), s1(0);
+    BigInt q, next;
+    Limbs nextX, nextY;
+    while (r1.limbs.size() >= 2) {
+        LehmerMatrix m;
+        if (lehmerMatrix(r0.limbs, r1.limbs, m)) {
+            combineLimbs(nextX, r0.limbs, m.a, r1.limbs, m.b);
+            combineLimbs(nextY, r0.limbs, m.c, r1.limbs, m.d);
+            r0.limbs.swap(nextX);
+            r1.limbs.swap(nextY);
+            next = s0 * m.a + s1 * m.b;
+            s1 = s0 * m.c + s1 * m.d;
+            std::swap(s0, next);
+            continue;
+        }
+        divmod(r0, r1, q, next);
+        std::swap(r0, r1);
+        std::swap(r1, next);
+        next = s0 - q * s1;
+        std::swap(s0, s1);
+        std::swap(s1, next);
+    }
+    while (!r1.isZero()) {
+        divmod(r0, r1, q, next);
+        std::swap(r0, r1);
+        std::swap(r1, next);
+        next = s0 - q * s1;
+        std::swap(s0, s1);
+        std::swap(s1, next);
+    }
     
-    while (!y.isZero()) {
-        BigInt temp = y;
-        y = x % y;
-        x = temp;
+    // s0 is now the cofactor of |larger|; turn it into the one of a.
+    BigInt g = r0;
+    if (larger.isNegative()) {
+        s0 = -s0;
+    }
+    BigInt cx, cy;
+    if (b.isZero()) {
+        cx = a.isZero() ? ZERO : s0;
+    } else if (a.isZero()) {
+        cy = s0;
+    } else {
+        if (swapped) {
+            s0 = (g - b * s0) / a;
+        }
+        // Shift x into (-|b| / 2g, |b| / 2g], where y is as small.
+        BigInt period = abs(b) / g;
+        divmod(s0, period, q, cx, DivisionMode::Euclidean);
+        if (cx + cx > period) {
+            cx -= period;
+        }
+        cy = (g - a * cx) / b;
+    }
+    // x and y may alias a or b.
+    x = std::move(cx);
+    y = std::move(cy);
+    return g;
+}
+
+BigInt BigInt::modInverse(const BigInt& a, const BigInt& m) {
+    if (!m.isPositive()) {
+        throw InvalidInputException("Modulus must be positive");
+    }
+    BigInt reduced, quotient, inverse, unused;
+    divmod(a, m, quotient, reduced, DivisionMode::Euclidean);
+    if (extendedGcd(reduced, m, inverse, unused) != ONE) {
+        throw InvalidInputException("Value is not invertible modulo m");
+    }
+    if (inverse.isNegative()) {
+        inverse += m;
     }
-    return x;
+    return inverse;
 }
 
 BigInt BigInt::lcm(const BigInt& a, const BigInt& b) {
     if (a.isZero() || b.isZero()) {
         return ZERO;
     }
-    return abs(a * b) / gcd(a, b);
+    return abs(a) / gcd(a, b) * abs(b);
 }
 
 bool BigInt::isPrime(const BigInt& n) {
+    BIGINT_STATS_SCOPE(IsPrime, n.limbs.size());
     if (n <= ONE) {
         return false;
     }
     if (n == TWO) {
         return true;
     }
-    if (n % TWO == ZERO) {
+    if ((n.limbs[0] & 1) == 0) {
         return false;
     }
-    
-    return isPrimeMillerRabin(n);
+    if (hasSmallFactor(n.limbs)) {
+        return false;
+    }
+    return isPrimeAfterSieve(n);
 }
 
-bool BigInt::isPrimeMillerRabin(const BigInt& n, int iterations) {
-    // Simple primality test for demo
-    BigInt num = abs(n);
-    if (num <= BigInt(100)) {
-        // For small numbers, use trial division
-        for (BigInt i = TWO; i * i <= num; i = i + ONE) {
-            if (num % i == ZERO) {
+bool BigInt::isPrimeAfterSieve(const BigInt& n) {
+    if (n.limbs.size() == 1) {
+        Limb value = n.limbs[0];
+        if (value < SMALL_PRIME_LIMIT * SMALL_PRIME_LIMIT) {
+            return true;
+        }
+        for (Limb base : MILLER_RABIN_64_BASES) {
+            if (!isStrongProbablePrime64(value, base)) {
                 return false;
             }
         }
         return true;
     }
     
-    // For larger numbers, use a simple probabilistic test
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(2, 100);
-    
-    for (int i = 0; i < iterations; ++i) {
-        BigInt a(dis(gen));
-        if (gcd(a, num) != ONE) {
+    // Baillie-PSW: a base-2 strong probable prime that is also a strong
+    // Lucas probable prime, with d chosen by Selfridge's method A.
+    ModContext context(n);
+    if (!context.isStrongProbablePrime(TWO)) {
+        return false;
+    }
+    Limb nMod4 = n.limbs[0] & 3;
+    long long d = 5;
+    for (;; d = d > 0 ? -(d + 2) : -d + 2) {
+        Limb magnitude = static_cast<Limb>(d > 0 ? d : -d);
+        // Reciprocity for odd magnitude, and (-1 / n) for negative d.
+        int symbol = jacobiSymbol(remainderBySingleLimb(n.limbs.data(), n.limbs.size(), magnitude),
+                                  magnitude);
+        if ((magnitude & 3) == 3 && nMod4 == 3) {
+            symbol = -symbol;
+        }
+        if (d < 0 && nMod4 == 3) {
+            symbol = -symbol;
+        }
+        if (symbol == -1) {
+            break;
+        }
+        if (symbol == 0) {
             return false;
         }
+        // Squares never yield -1, so rule them out once the search runs on.
+        if (d == 13) {
+            BigInt root = sqrt(n);
+            if (square(root) == n) {
+                return false;
+            }
+        }
     }
-    return true;
+    return context.isStrongLucasProbablePrime(d);
 }
 
-std::vector<std::pair<BigInt, int>> BigInt::primeFactorization(const BigInt& n) {
-    std::vector<std::pair<BigInt, int>> factors;
-    BigInt num = abs(n);
+BigInt BigInt::searchPrime(const BigInt& start, const BigInt* limit, unsigned threads) {
+    BigInt windowStart = start;
+    BigInt windowSpan(static_cast<long long>(2 * PRIME_SIEVE_WINDOW));
+    std::vector<unsigned char> composite;
+    std::vector<BigInt> survivors;
+    for (;;) {
+        sieveWindow(windowStart.limbs, composite);
+        survivors.clear();
+        for (size_t i = 0; i < PRIME_SIEVE_WINDOW; ++i) {
+            if (composite[i]) {
+                continue;
+            }
+            BigInt candidate = windowStart + 2 * i;
+            if (limit && candidate >= *limit) {
+                break;
+            }
+            survivors.push_back(std::move(candidate));
+        }
+        
+        size_t found = survivors.size();
+        if (threads <= 1 || survivors.size() < 2) {
+            for (size_t i = 0; i < survivors.size(); ++i) {
+                if (isPrimeAfterSieve(survivors[i])) {
+                    found = i;
+                    break;
+                }
+            }
+        } else {
+            // Survivors are claimed in increasing order, so once one is prime
+            // every smaller index has already been claimed; workers finish
+            // those and skip the rest.
+            std::atomic<size_t> next(0);
+            std::atomic<size_t> best(survivors.size());
+            auto worker = [&] {
+                for (size_t i = next++; i < best.load(); i = next++) {
+                    if (isPrimeAfterSieve(survivors[i])) {
+                        size_t current = best.load();
+                        while (i < current && !best.compare_exchange_weak(current, i)) {
+                        }
+                    }
+                }
+            };
+            TaskGroup group;
+            size_t count = std::min<size_t>(threads, survivors.size());
+            for (size_t t = 1; t < count; ++t) {
+                group.run(worker);
+            }
+            worker();
+            group.wait();
+            found = best.load();
+        }
+        
+        if (found < survivors.size()) {
+            return survivors[found];
+        }
+        windowStart += windowSpan;
+        if (limit && windowStart >= *limit) {
+            return BigInt();
+        }
+    }
+}
+
+BigInt BigInt::nextPrime(const BigInt& n, unsigned threads) {
+    if (n < TWO) {
+        return TWO;
+    }
+    BigInt start = n + 1;
+    if ((start.limbs[0] & 1) == 0) {
+        ++start;
+    }
+    return searchPrime(start, nullptr, threads);
+}
+
+BigInt BigInt::randomPrimeFrom(size_t bits, const std::function<uint64_t()>& randomLimb,
+                               unsigned threads) {
+    if (bits < 2) {
+        throw InvalidInputException("Random primes need at least 2 bits");
+    }
+    size_t count = (bits + 63) / 64;
+    size_t topBit = (bits - 1) % 64;
+    BigInt limit;
+    limit.limbs.assign(bits / 64 + 1, 0);
+    limit.limbs.back() = Limb(1) << (bits % 64);
+    
+    for (;;) {
+        BigInt start;
+        start.limbs.resize(count);
+        for (Limb& limb : start.limbs) {
+            limb = randomLimb();
+        }
+        Limb& top = start.limbs.back();
+        top &= topBit == 63 ? ~Limb(0) : (Limb(1) << (topBit + 1)) - 1;
+        top |= Limb(1) << topBit;
+        start.limbs[0] |= 1;
+        
+        BigInt prime = searchPrime(start, &limit, threads);
+        if (!prime.isZero()) {
+            return prime;
+        }
+    }
+}
+
+std::vector<std::pair<BigInt, int>> BigInt::primeFactorization(const BigInt& n,
+                                                               const ProgressCallback& progress) {
+    BIGINT_STATS_SCOPE(Factorize, n.limbs.size());
+    std::vector<BigInt> primes;
+    FactorizationProgress report{FactorizationProgress::TRIAL_DIVISION, BigInt(), 0, 0, 0};
+    auto checkpoint = [&](FactorizationProgress::Stage stage, const BigInt& composite,
+                          uint64_t work, uint64_t bound) {
+        if (!progress) {
+            return;
+        }
+        report.stage = stage;
+        report.composite = composite;
+        report.work = work;
+        report.bound = bound;
+        report.factorsFound = primes.size();
+        if (!progress(report)) {
+            throw OperationCancelledException("Factorization cancelled");
+        }
+    };
     
+    BigInt num = abs(n);
     if (num <= ONE) {
-        return factors;
+        return {};
     }
     
-    // Check for 2
-    int count = 0;
-    while (num % TWO == ZERO) {
-        num = num / TWO;
-        count++;
+    // Trial division, first by the sieve primes a group product at a time.
+    while ((num.limbs[0] & 1) == 0) {
+        primes.push_back(TWO);
+        divModSmall(num.limbs, 2);
     }
-    if (count > 0) {
-        factors.emplace_back(TWO, count);
+    const SmallPrimeTable& table = smallPrimeTable();
+    for (const SmallPrimeTable::Group& group : table.groups) {
+        if (num.limbs.empty() || num == ONE) {
+            break;
+        }
+        Limb rem = remainderBySingleLimb(num.limbs.data(), num.limbs.size(), group.product);
+        for (size_t i = group.first; i < group.last; ++i) {
+            Limb p = table.primes[i];
+            if (rem % p != 0) {
+                continue;
+            }
+            Limbs quotient = num.limbs;
+            while (divModSmall(quotient, p) == 0) {
+                primes.push_back(BigInt(static_cast<long long>(p)));
+                num.limbs = quotient;
+            }
+        }
     }
-    
-    // Check odd numbers up to sqrt(num)
-    BigInt i(3);
-    BigInt sqrtNum = sqrt(num);
-    
-    while (i <= sqrtNum) {
-        count = 0;
-        while (num % i == ZERO) {
-            num = num / i;
-            count++;
+    // Then by the numbers coprime to 210 past the sieve primes.
+    for (Limb p = SMALL_PRIME_LIMIT / 210 * 210 + 1, spoke = 0; p < TRIAL_DIVISION_LIMIT;
+         p += WHEEL_GAPS[spoke], spoke = (spoke + 1) % WHEEL_SPOKES) {
+        if (p < SMALL_PRIME_LIMIT) {
+            continue;
+        }
+        if (num.limbs.size() == 1 && num.limbs[0] / p < p) {
+            break;
         }
-        if (count > 0) {
-            factors.emplace_back(i, count);
+        while (remainderBySingleLimb(num.limbs.data(), num.limbs.size(), p) == 0) {
+            primes.push_back(BigInt(static_cast<long long>(p)));
+            divModSmall(num.limbs, p);
         }
-        i += TWO;
     }
     
+    checkpoint(FactorizationProgress::TRIAL_DIVISION, num, 0, 0);
+    
+    // Split the remaining cofactors, keeping composites on a work list.
+    std::vector<BigInt> composites;
     if (num > ONE) {
-        factors.emplace_back(num, 1);
+        composites.push_back(num);
+    }
+    // Per-thread source of rho and ECM parameters, kept across calls; any
+    // sequence finds the same factors.
+    static thread_local std::mt19937_64 rng(0x9E3779B97F4A7C15ULL);
+    while (!composites.empty()) {
+        BigInt m = std::move(composites.back());
+        composites.pop_back();
+        if (m.limbs.size() == 1 && m.limbs[0] < TRIAL_DIVISION_LIMIT * TRIAL_DIVISION_LIMIT) {
+            primes.push_back(m);
+            continue;
+        }
+        if (isPrimeAfterSieve(m)) {
+            primes.push_back(m);
+            continue;
+        }
+        
+        BigInt factor;
+        if (m.limbs.size() == 1) {
+            Limb value = m.limbs[0];
+            Limb divisor = 0;
+            while (divisor == 0 || divisor == value) {
+                divisor = pollardBrent64(value, rng() % (value - 1) + 1, rng() % (value - 3) + 1, m,
+                                         checkpoint);
+            }
+            factor.limbs.assign(1, divisor);
+        } else {
+            factor = splitComposite(m, rng, checkpoint);
+        }
+        composites.push_back(factor);
+        composites.push_back(m / factor);
     }
     
+    std::sort(primes.begin(), primes.end());
+    std::vector<std::pair<BigInt, int>> factors;
+    for (const BigInt& p : primes) {
+        if (!factors.empty() && factors.back().first == p) {
+            ++factors.back().second;
+        } else {
+            factors.emplace_back(p, 1);
+        }
+    }
     return factors;
 }
 
@@ -564,26 +3640,142 @@ BigInt BigInt::sqrt(const BigInt& n) {
         throw InvalidInputException("Square root not defined for negative numbers");
     }
     
-    if (n <= ONE) {
-        return n;
+    BigInt result;
+    if (n.limbs.size() <= 1) {
+        if (!n.limbs.empty()) {
+            result.limbs.assign(1, isqrt64(n.limbs[0]));
+        }
+        return result;
     }
     
-    BigInt left(1), right = n;
-    BigInt result(1);
+    // floor(sqrt(n >> 2k)) << k is within 2^-(bits/4) of the root, so the
+    // Newton step lands within a unit or two above it.
+    size_t shift = significantBits(n.limbs) / 4;
+    BigInt top;
+    top.limbs = shiftRightLimbs(n.limbs, 2 * shift);
+    result.limbs = shiftLeftLimbs(sqrt(top).limbs, shift);
+    do {
+        result += n / result;
+        result.limbs = shiftRightLimbs(result.limbs, 1);
+    } while (square(result) > n);
+    return result;
+}
+
+std::pair<BigInt, BigInt> BigInt::isqrtrem(const BigInt& n) {
+    std::pair<BigInt, BigInt> result;
+    isqrtrem(n, result.first, result.second);
+    return result;
+}
+
+void BigInt::isqrtrem(const BigInt& n, BigInt& root, BigInt& remainder) {
+    root = sqrt(n);
+    remainder = n - square(root);
+}
+
+BigInt BigInt::nthRoot(const BigInt& n, int k) {
+    if (k < 1) {
+        throw InvalidInputException("Root degree must be positive");
+    }
+    if (n.negative) {
+        if (k % 2 == 0) {
+            throw InvalidInputException("Even root not defined for negative numbers");
+        }
+        return -nthRoot(-n, k);
+    }
+    if (k == 1 || n <= ONE) {
+        return n;
+    }
+    if (k == 2) {
+        return sqrt(n);
+    }
+    size_t bits = significantBits(n.limbs);
+    if (static_cast<size_t>(k) >= bits) {
+        return ONE;
+    }
     
-    while (left <= right) {
-        BigInt mid = (left + right) / TWO;
-        BigInt square = mid * mid;
-        
-        if (square <= n) {
-            result = mid;
-            left = mid + ONE;
+    // Long roots start from the root of the top part of n, shifted into
+    // place, and short ones from log2(n) / k taken from the top two limbs.
+    BigInt x;
+    if (bits / k > 128) {
+        size_t shift = bits / k / 2;
+        BigInt top;
+        top.limbs = shiftRightLimbs(n.limbs, shift * k);
+        x.limbs = shiftLeftLimbs(nthRoot(top, k).limbs, shift);
+    } else {
+        size_t size = n.limbs.size();
+        double leading = static_cast<double>(n.limbs[size - 1]);
+        size_t scale = 0;
+        if (size >= 2) {
+            leading = leading * 18446744073709551616.0 + static_cast<double>(n.limbs[size - 2]);
+            scale = 64 * (size - 2);
+        }
+        double logRoot = (std::log2(leading) + static_cast<double>(scale)) / k;
+        if (logRoot < 62) {
+            x.limbs.assign(1, static_cast<Limb>(std::exp2(logRoot)) + 1);
         } else {
-            right = mid - ONE;
+            double whole = std::floor(logRoot);
+            Limbs mantissa(1, static_cast<Limb>(std::exp2(logRoot - whole + 52)));
+            x.limbs = shiftLeftLimbs(mantissa, static_cast<size_t>(whole) - 52);
+        }
+    }
+
+    // x <- ((k - 1) x + n / x^(k - 1)) / k lands at or above the root from
+    // any start and then decreases to it.
+    BigInt degree(k), lower(k - 1);
+    BigInt power = pow(x, lower);
+    for (bool first = true;; first = false) {
+        if (!first && power * x <= n) {
+            return x;
+        }
+        x = (lower * x + n / power) / degree;
+        power = pow(x, lower);
+    }
+}
+
+bool BigInt::isPerfectPower(const BigInt& n, BigInt* root, int* exponent) {
+    BigInt base = abs(n);
+    int power = 1;
+    if (base <= ONE) {
+        power = n.negative ? 3 : 2;
+    } else {
+        // Squares are restricted to 12 residues mod 64.
+        auto maybeSquare = [](const BigInt& x) {
+            Limb residue = x.limbs[0] & 63;
+            for (Limb i = 0; i < 32; ++i) {
+                if (((i * i) & 63) == residue) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        // Only prime exponents need trying, repeatedly while they divide.
+        for (int k = n.negative ? 3 : 2; static_cast<size_t>(k) < significantBits(base.limbs);) {
+            bool primeExponent = true;
+            for (int d = 2; d * d <= k; ++d) {
+                primeExponent = primeExponent && k % d != 0;
+            }
+            if (primeExponent && (k != 2 || maybeSquare(base))) {
+                BigInt candidate = nthRoot(base, k);
+                if (pow(candidate, BigInt(k)) == base) {
+                    base = candidate;
+                    power *= k;
+                    continue;
+                }
+            }
+            k += k == 2 ? 1 : 2;
         }
     }
     
-    return result;
+    if (power == 1) {
+        return false;
+    }
+    if (root) {
+        *root = n.negative ? -base : base;
+    }
+    if (exponent) {
+        *exponent = power;
+    }
+    return true;
 }
 
 BigInt BigInt::pow(const BigInt& base, const BigInt& exponent) {
@@ -595,72 +3787,536 @@ BigInt BigInt::pow(const BigInt& base, const BigInt& exponent) {
         return ONE;
     }
     
-    BigInt result(1);
-    BigInt b = base;
-    BigInt e = exponent;
-    
-    while (!e.isZero()) {
-        if (e % TWO == ONE) {
-            result = result * b;
+    // Left to right, so every multiplication is by the base itself rather
+    // than by a growing power of it.
+    BigInt result = base;
+    for (size_t i = exponent.bitLength() - 1; i-- > 0;) {
+        result = square(result);
+        if (exponent.testBit(i)) {
+            result *= base;
         }
-        b = b * b;
-        e = e / TWO;
     }
     
     return result;
 }
 
+BigInt BigInt::square(const BigInt& n) {
+    BIGINT_STATS_SCOPE(Multiply, 2 * n.limbs.size());
+    if (n.isZero()) {
+        return ZERO;
+    }
+    
+    BigInt result;
+    result.limbs.resize(2 * n.limbs.size());
+    multiplyLimbs(result.limbs.data(), n.limbs.data(), n.limbs.size(),
+                  n.limbs.data(), n.limbs.size());
+    result.normalize();
+    return result;
+}
+
 BigInt BigInt::modPow(const BigInt& base, const BigInt& exponent, const BigInt& modulus) {
+    return ModContext(modulus).modPow(base, exponent);
+}
+
+// Modular arithmetic context
+BigInt::ModContext::ModContext(const BigInt& modulus)
+    : mod(modulus), montgomery(false), inverse(0) {
     if (modulus <= ZERO) {
         throw InvalidInputException("Modulus must be positive");
     }
     
-    if (exponent < ZERO) {
+    size_t n = mod.limbs.size();
+    montgomery = (mod.limbs[0] & 1) != 0 && n <= MONTGOMERY_LIMIT;
+    if (montgomery) {
+        // Newton's iteration doubles the correct low bits of m^-1 each step,
+        // starting from m itself, which is its own inverse mod 8.
+        Limb m0 = mod.limbs[0];
+        Limb x = m0;
+        for (int i = 0; i < 5; ++i) {
+            x *= 2 - m0 * x;
+        }
+        inverse = 0 - x;
+        
+        Limbs power(2 * n + 1, 0);
+        power[2 * n] = 1;
+        Limbs quotient;
+        divideLimbs(power, mod.limbs, quotient, rSquared);
+        rSquared.resize(n, 0);
+    } else {
+        Limbs power(2 * n + 1, 0);
+        power[2 * n] = 1;
+        Limbs remainder;
+        divideLimbs(power, mod.limbs, mu, remainder);
+    }
+}
+
+// r = t / R mod m for t < m * R held in 2n + 1 limbs, which it clobbers.
+void BigInt::ModContext::montgomeryReduce(Limbs& r, Limbs& t) const {
+    size_t n = mod.limbs.size();
+    const Limb* m = mod.limbs.data();
+    for (size_t i = 0; i < n; ++i) {
+        Limb u = t[i] * inverse;
+        Limb carry = addMultipleRow(t.data() + i, m, n, u);
+        Limb bit = 0;
+        t[i + n] = addCarry(t[i + n], carry, bit);
+        for (size_t k = i + n + 1; bit; ++k) {
+            t[k] = addCarry(t[k], 0, bit);
+        }
+    }
+    
+    // The quotient is below 2m, so one subtraction suffices.
+    r.resize(n);
+    const Limb* high = t.data() + n;
+    bool reduce = t[2 * n] != 0;
+    if (!reduce) {
+        reduce = true;
+        for (size_t i = n; i-- > 0;) {
+            if (high[i] != m[i]) {
+                reduce = high[i] > m[i];
+                break;
+            }
+        }
+    }
+    if (reduce) {
+        subLimbs(r.data(), high, n, m, n);
+    } else {
+        std::copy(high, high + n, r.data());
+    }
+}
+
+// x = x mod m for x < m^2.
+void BigInt::ModContext::barrettReduce(Limbs& x) const {
+    if (compareLimbs(x, mod.limbs) < 0) {
+        return;
+    }
+    size_t n = mod.limbs.size();
+    Limbs estimate = dropLowLimbs(multiplyVectors(dropLowLimbs(x, n - 1), mu), n + 1);
+    subtractInPlace(x, multiplyVectors(estimate, mod.limbs));
+    while (compareLimbs(x, mod.limbs) >= 0) {
+        subtractInPlace(x, mod.limbs);
+    }
+}
+
+void BigInt::ModContext::multiplyDomain(Limbs& r, const Limbs& a, const Limbs& b,
+                                        Limbs& scratch) const {
+    if (montgomery) {
+        size_t n = mod.limbs.size();
+        scratch.resize(2 * n + 1);
+        multiplyLimbs(scratch.data(), a.data(), n, b.data(), n);
+        scratch[2 * n] = 0;
+        montgomeryReduce(r, scratch);
+        return;
+    }
+    
+    if (a.empty() || b.empty()) {
+        r.clear();
+        return;
+    }
+    scratch.resize(a.size() + b.size());
+    multiplyLimbs(scratch.data(), a.data(), a.size(), b.data(), b.size());
+    trimLimbs(scratch);
+    barrettReduce(scratch);
+    r.swap(scratch);
+}
+
+void BigInt::ModContext::toDomain(const BigInt& x, Limbs& r) const {
+    r = reduce(x).limbs;
+    if (montgomery) {
+        Limbs scratch;
+        r.resize(mod.limbs.size(), 0);
+        multiplyDomain(r, r, rSquared, scratch);
+    }
+}
+
+BigInt BigInt::ModContext::fromDomain(const Limbs& x) const {
+    BigInt result;
+    if (montgomery) {
+        size_t n = mod.limbs.size();
+        Limbs t(2 * n + 1, 0);
+        std::copy(x.begin(), x.end(), t.begin());
+        montgomeryReduce(result.limbs, t);
+    } else {
+        result.limbs = x;
+    }
+    result.normalize();
+    return result;
+}
+
+BigInt BigInt::ModContext::reduce(const BigInt& x) const {
+    if (compareLimbs(x.limbs, mod.limbs) < 0 && !x.negative) {
+        return x;
+    }
+    BigInt result;
+    Limbs quotient;
+    divideLimbs(x.limbs, mod.limbs, quotient, result.limbs);
+    if (x.negative && !result.limbs.empty()) {
+        subtractFromInPlace(result.limbs, mod.limbs);
+    }
+    return result;
+}
+
+BigInt BigInt::ModContext::multiply(const BigInt& a, const BigInt& b) const {
+    Limbs x, y, scratch;
+    toDomain(a, x);
+    toDomain(b, y);
+    multiplyDomain(x, x, y, scratch);
+    return fromDomain(x);
+}
+
+BigInt BigInt::ModContext::square(const BigInt& a) const {
+    Limbs x, scratch;
+    toDomain(a, x);
+    multiplyDomain(x, x, x, scratch);
+    return fromDomain(x);
+}
+
+BigInt BigInt::ModContext::modPow(const BigInt& base, const BigInt& exponent) const {
+    BIGINT_STATS_SCOPE(ModPow, mod.limbs.size());
+    if (exponent.negative) {
         throw InvalidInputException("Negative exponent not supported");
     }
+    if (mod == ONE) {
+        return BigInt();
+    }
+    if (exponent.isZero()) {
+        return ONE;
+    }
+    
+    const Limbs& e = exponent.limbs;
+    size_t bits = e.size() * 64 - static_cast<size_t>(countLeadingZeros(e.back()));
+    auto bit = [&e](size_t i) { return (e[i / 64] >> (i % 64)) & 1; };
+    
+    // Window width trading the 2^(w-1) precomputed odd powers against the
+    // multiplications saved.
+    size_t width = bits <= 24 ? 1 : bits <= 80 ? 3 : bits <= 240 ? 4 : bits <= 672 ? 5 : 6;
+    
+    Limbs scratch;
+    std::vector<Limbs> oddPowers(size_t(1) << (width - 1));
+    toDomain(base, oddPowers[0]);
+    if (oddPowers.size() > 1) {
+        Limbs baseSquared;
+        multiplyDomain(baseSquared, oddPowers[0], oddPowers[0], scratch);
+        for (size_t i = 1; i < oddPowers.size(); ++i) {
+            multiplyDomain(oddPowers[i], oddPowers[i - 1], baseSquared, scratch);
+        }
+    }
+    
+    // Left to right: each window is a run of at most `width` bits starting
+    // and ending with a one, preceded by as many squarings as it has bits.
+    Limbs result;
+    bool started = false;
+    for (size_t i = bits; i-- > 0;) {
+        if (!bit(i)) {
+            multiplyDomain(result, result, result, scratch);
+            continue;
+        }
+        size_t low = i + 1 >= width ? i + 1 - width : 0;
+        while (!bit(low)) {
+            ++low;
+        }
+        size_t window = 0;
+        for (size_t j = i + 1; j-- > low;) {
+            window = (window << 1) | bit(j);
+            if (started) {
+                multiplyDomain(result, result, result, scratch);
+            }
+        }
+        if (started) {
+            multiplyDomain(result, result, oddPowers[window / 2], scratch);
+        } else {
+            result = oddPowers[window / 2];
+            started = true;
+        }
+        i = low;
+    }
+    return fromDomain(result);
+}
+
+bool BigInt::ModContext::isStrongProbablePrime(const BigInt& base) const {
+    Limbs minusOne = mod.limbs;
+    decrementLimbs(minusOne);
+    size_t s = trailingZeroBits(minusOne);
+    BigInt d;
+    d.limbs = shiftRightLimbs(minusOne, s);
+    
+    BigInt x = modPow(base, d);
+    if (x.isZero() || x == ONE || x.limbs == minusOne) {
+        return true;
+    }
+    Limbs y, target, scratch;
+    toDomain(x, y);
+    BigInt nMinusOne;
+    nMinusOne.limbs = minusOne;
+    toDomain(nMinusOne, target);
+    for (size_t r = 1; r < s; ++r) {
+        multiplyDomain(y, y, y, scratch);
+        if (y == target) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Binary Lucas chain over d = (n + 1) / 2^s, from (U_1, V_1) = (1, P) and
+// Q^1: doubling takes U_2k = U_k V_k and V_2k = V_k^2 - 2 Q^k, and an
+// increment takes U_k+1 = (P U_k + V_k) / 2 and V_k+1 = (D U_k + P V_k) / 2.
+// n is a strong Lucas probable prime when U_d = 0 or V_(d 2^r) = 0 for some
+// r < s. Everything stays in the working representation, where addition,
+// subtraction and halving mod n behave as they do on plain residues.
+bool BigInt::ModContext::isStrongLucasProbablePrime(long long d) const {
+    size_t n = mod.limbs.size();
+    const Limbs& m = mod.limbs;
+    Limbs scratch;
+    // Montgomery multiplication reads exactly n limbs of each operand.
+    auto multiply = [&](Limbs& r, Limbs& a, Limbs& b) {
+        if (montgomery) {
+            a.resize(n, 0);
+            b.resize(n, 0);
+        }
+        multiplyDomain(r, a, b, scratch);
+        trimLimbs(r);
+        trimLimbs(a);
+        trimLimbs(b);
+    };
+    auto constant = [&](long long value) {
+        Limbs r;
+        toDomain(BigInt(value), r);
+        trimLimbs(r);
+        return r;
+    };
     
-    BigInt result(1);
-    BigInt b = base % modulus;
-    BigInt e = exponent;
+    Limbs nPlusOne = m;
+    incrementLimbs(nPlusOne);
+    size_t s = trailingZeroBits(nPlusOne);
+    Limbs k = shiftRightLimbs(nPlusOne, s);
+    size_t bits = k.size() * 64 - static_cast<size_t>(countLeadingZeros(k.back()));
     
-    while (!e.isZero()) {
-        if (e % TWO == ONE) {
-            result = (result * b) % modulus;
+    Limbs discriminant = constant(d);
+    Limbs q = constant((1 - d) / 4);
+    Limbs u = constant(1);
+    Limbs v = u;
+    Limbs qk = q;
+    Limbs t;
+    for (size_t i = bits - 1; i-- > 0;) {
+        multiply(u, u, v);
+        multiply(v, v, v);
+        t = qk;
+        addModLimbs(t, qk, m);
+        subtractModLimbs(v, t, m);
+        multiply(qk, qk, qk);
+        if ((k[i / 64] >> (i % 64)) & 1) {
+            multiply(t, discriminant, u);
+            addModLimbs(u, v, m);
+            halveModLimbs(u, m);
+            addModLimbs(v, t, m);
+            halveModLimbs(v, m);
+            multiply(qk, qk, q);
         }
-        b = (b * b) % modulus;
-        e = e / TWO;
     }
     
+    if (u.empty() || v.empty()) {
+        return true;
+    }
+    for (size_t r = 1; r < s; ++r) {
+        multiply(v, v, v);
+        t = qk;
+        addModLimbs(t, qk, m);
+        subtractModLimbs(v, t, m);
+        if (v.empty()) {
+            return true;
+        }
+        multiply(qk, qk, qk);
+    }
+    return false;
+}
+
+// Residues are always padded to exactly n limbs, whichever reduction is in use.
+BigInt::ModContext::Residue BigInt::ModContext::toResidue(const BigInt& x) const {
+    Residue r;
+    toDomain(x, r.limbs);
+    r.limbs.resize(mod.limbs.size(), 0);
+    return r;
+}
+
+BigInt BigInt::ModContext::fromResidue(const Residue& x) const {
+    if (montgomery) {
+        return fromDomain(x.limbs);
+    }
+    BigInt result;
+    result.limbs = x.limbs;
+    result.normalize();
     return result;
 }
 
+void BigInt::ModContext::add(Residue& r, const Residue& a, const Residue& b) const {
+    size_t n = mod.limbs.size();
+    r.limbs.resize(n);
+    Limb carry = addLimbs(r.limbs.data(), a.limbs.data(), n, b.limbs.data(), n);
+    bool reduce = carry != 0;
+    if (!reduce) {
+        reduce = true;
+        for (size_t i = n; i-- > 0;) {
+            if (r.limbs[i] != mod.limbs[i]) {
+                reduce = r.limbs[i] > mod.limbs[i];
+                break;
+            }
+        }
+    }
+    if (reduce) {
+        subLimbs(r.limbs.data(), r.limbs.data(), n, mod.limbs.data(), n);
+    }
+}
+
+void BigInt::ModContext::subtract(Residue& r, const Residue& a, const Residue& b) const {
+    size_t n = mod.limbs.size();
+    r.limbs.resize(n);
+    if (subLimbs(r.limbs.data(), a.limbs.data(), n, b.limbs.data(), n)) {
+        addLimbs(r.limbs.data(), r.limbs.data(), n, mod.limbs.data(), n);
+    }
+}
+
+void BigInt::ModContext::multiply(Residue& r, const Residue& a, const Residue& b) const {
+    static thread_local Limbs scratch(nullptr);
+    multiplyDomain(r.limbs, a.limbs, b.limbs, scratch);
+    r.limbs.resize(mod.limbs.size(), 0);
+}
+
+bool BigInt::ModContext::isZero(const Residue& x) const {
+    for (Limb limb : x.limbs) {
+        if (limb != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // Performance and utility
 void BigInt::reserve(size_t size) {
-    digits.reserve(size);
+    limbs.reserve(size);
 }
 
 size_t BigInt::size() const {
-    return digits.size();
+    return limbs.size();
 }
 
 void BigInt::clear() {
-    digits = {0};
+    limbs.clear();
     negative = false;
 }
 
+std::pmr::memory_resource* BigInt::getMemoryResource() {
+    return LimbVector::currentResource();
+}
+
+void BigInt::setMemoryResource(std::pmr::memory_resource* resource) {
+    LimbVector::currentResource() = resource;
+}
+
+BigInt::PoolScope::PoolScope() : previous(getMemoryResource()) {
+    setMemoryResource(&pool);
+}
+
+BigInt::PoolScope::~PoolScope() {
+    setMemoryResource(previous);
+}
+
 // I/O operators
+// Base selected by a stream's basefield flags.
+static int streamBase(const std::ios_base& stream) {
+    std::ios_base::fmtflags basefield = stream.flags() & std::ios_base::basefield;
+    if (basefield == std::ios_base::hex) {
+        return 16;
+    }
+    if (basefield == std::ios_base::oct) {
+        return 8;
+    }
+    return 10;
+}
+
+// Honours std::hex, std::oct, std::showbase and std::uppercase.
 std::ostream& operator<<(std::ostream& os, const BigInt& num) {
-    os << num.toString();
-    return os;
+    int base = streamBase(os);
+    if (base == 10) {
+        return os << num.toString();
+    }
+    
+    std::string digits = abs(num).toString(base);
+    if (os.flags() & std::ios_base::uppercase) {
+        std::transform(digits.begin(), digits.end(), digits.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    }
+    std::string prefix = num.isNegative() ? "-" : "";
+    if ((os.flags() & std::ios_base::showbase) && !num.isZero()) {
+        prefix += base == 16 ? ((os.flags() & std::ios_base::uppercase) ? "0X" : "0x") : "0";
+    }
+    return os << prefix + digits;
 }
 
+// Reads a token in the stream's base; with std::hex an optional 0x or 0X
+// prefix after the sign is accepted.
 std::istream& operator>>(std::istream& is, BigInt& num) {
     std::string str;
-    is >> str;
-    num = BigInt(str);
+    if (is >> str) {
+        int base = streamBase(is);
+        const char* first = str.data();
+        const char* last = first + str.length();
+        if (base == 16) {
+            size_t sign = (!str.empty() && (str[0] == '-' || str[0] == '+')) ? 1 : 0;
+            if (str.length() > sign + 2 && str[sign] == '0' && (str[sign + 1] == 'x' || str[sign + 1] == 'X')) {
+                str.erase(sign, 2);
+                first = str.data();
+                last = first + str.length();
+            }
+        }
+        num.assignDigits(first, last, base);
+    }
     return is;
 }
 
+std::from_chars_result from_chars(const char* first, const char* last, BigInt& value, int base) {
+    checkBase(base);
+    const char* p = first;
+    bool negative = p != last && *p == '-';
+    if (negative) {
+        ++p;
+    }
+    const char* digits = p;
+    while (p != last && digitValue(*p) < static_cast<Limb>(base)) {
+        ++p;
+    }
+    if (p == digits) {
+        return {first, std::errc::invalid_argument};
+    }
+    
+    parseMagnitude(digits, p, base, value.limbs);
+    value.negative = negative;
+    value.normalize();
+    return {p, std::errc()};
+}
+
+std::to_chars_result to_chars(char* first, char* last, const BigInt& value, int base) {
+    checkBase(base);
+    if (value.negative) {
+        if (first == last) {
+            return {last, std::errc::value_too_large};
+        }
+        *first++ = '-';
+    }
+    if (value.isZero()) {
+        if (first == last) {
+            return {last, std::errc::value_too_large};
+        }
+        *first++ = '0';
+        return {first, std::errc()};
+    }
+    
+    char* end = writeMagnitude(value.limbs, base, first, last);
+    if (!end) {
+        return {last, std::errc::value_too_large};
+    }
+    return {end, std::errc()};
+}
+
 // Non-member functions
 BigInt abs(const BigInt& num) {
     return num.isNegative() ? -num : num;
@@ -676,5 +4332,5 @@ BigInt max(const BigInt& a, const BigInt& b) {
 
 // Literal operator
 BigInt operator""_bigint(const char* str, size_t size) {
-    return BigInt(std::string(str, size));
+    return BigInt(std::string_view(str, size));
 }
\ No newline at end of file
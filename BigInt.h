@@ -1,11 +1,20 @@
 #ifndef BIGINT_H
 #define BIGINT_H
 
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <random>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 #include <iostream>
 #include <memory>
+#include <memory_resource>
 #include <stdexcept>
+#include "LimbPool.h"
+#include "LimbVector.h"
 
 // Exception classes
 class DivisionByZeroException : public std::runtime_error {
@@ -38,31 +47,124 @@ public:
         : std::out_of_range(message) {}
 };
 
+class OperationCancelledException : public std::runtime_error {
+public:
+    explicit OperationCancelledException(const std::string& message = "Operation cancelled")
+        : std::runtime_error(message) {}
+};
+
+// Thread safety. BigInt follows the standard library's rules: any number of
+// threads may call const members and static functions on shared values, and
+// a value being modified needs exclusive access. ZERO, ONE and TWO are
+// constant from static initialization on. The tables the library builds
+// for itself (sieve primes, powers of each conversion radix) are created on
+// first use, never change afterwards and are read without locking. Scratch
+// buffers and random state are per thread, so concurrent callers neither
+// contend nor reallocate, and a ModContext may be shared between threads.
+// setMemoryResource and PoolScope act on the calling thread only. The
+// process-wide settings, setMultiplyThresholds and setParallelPolicy, are
+// not synchronized: change them while no other thread is computing.
 class BigInt {
 private:
-    std::vector<int> digits;
+    // Magnitude as little-endian base-2^64 limbs with no leading zero limbs;
+    // zero is the empty vector and is never negative. Values up to two limbs
+    // are stored inline without a heap allocation.
+    LimbVector limbs;
     bool negative;
     
     // Helper methods
     void normalize();
     void removeLeadingZeros();
     int compareMagnitude(const BigInt& other) const;
-    BigInt schoolbookMultiply(const BigInt& other) const;
-    static std::pair<BigInt, BigInt> divideWithRemainder(const BigInt& dividend, const BigInt& divisor);
-    static bool isPrimeMillerRabin(const BigInt& n, int iterations = 5);
+    // sign * (|a| + |b|), and sign * (|a| - |b|) with the sign flipped when
+    // |b| > |a|. The operands are read in place, never copied.
+    static BigInt addMagnitude(const BigInt& a, const BigInt& b, bool negative);
+    static BigInt subMagnitude(const BigInt& a, const BigInt& b, bool negative);
+    // accumulator += |a| * |b| carrying the given sign.
+    static void accumulateProduct(BigInt& accumulator, const BigInt& a, const BigInt& b,
+                                  bool productNegative);
+    // Parses [first, last) in base with the string constructor's rules,
+    // throwing InvalidInputException on malformed input.
+    void assignDigits(const char* first, const char* last, int base);
     static BigInt modPow(const BigInt& base, const BigInt& exponent, const BigInt& modulus);
+    // isPrime for odd n that trial division has already cleared.
+    static bool isPrimeAfterSieve(const BigInt& n);
+    // Smallest prime >= start (odd, at least 3) and below limit, or zero when
+    // there is none; limit may be null for no bound.
+    static BigInt searchPrime(const BigInt& start, const BigInt* limit, unsigned threads);
+    static BigInt randomPrimeFrom(size_t bits, const std::function<uint64_t()>& randomLimb,
+                                  unsigned threads);
+    
+    // Integral types other than bool that fit in a limb, taken by the
+    // native-operand operators. __int128 converts through the exact
+    // constructor below instead.
+    template <typename Native>
+    using EnableIfNative =
+        std::enable_if_t<std::is_integral<Native>::value && !std::is_same<Native, bool>::value &&
+                         sizeof(Native) <= sizeof(uint64_t)>;
+#if defined(__SIZEOF_INT128__)
+    // Named rather than found through std::is_integral, which does not count
+    // __int128 under strict -std=c++17.
+    template <typename Wide>
+    using EnableIfWide = std::enable_if_t<std::is_same<Wide, __int128>::value ||
+                                          std::is_same<Wide, unsigned __int128>::value>;
+#endif
+    template <typename Native>
+    static bool isNativeNegative(Native value) {
+        return std::is_signed<Native>::value && static_cast<long long>(value) < 0;
+    }
+    template <typename Native>
+    static uint64_t nativeMagnitude(Native value) {
+        uint64_t bits = static_cast<uint64_t>(value);
+        return isNativeNegative(value) ? 0 - bits : bits;
+    }
+    // Single-limb kernels on a native operand's sign and magnitude:
+    // this += +-magnitude, this *= +-magnitude, this /= +-magnitude
+    // truncating and returning |remainder|, and this %= magnitude.
+    void addNative(uint64_t magnitude, bool negate);
+    void multiplyNative(uint64_t magnitude, bool negate);
+    uint64_t divideNative(uint64_t magnitude, bool negate);
+    void remainderNative(uint64_t magnitude);
 
 public:
     // Constructors
     BigInt();
     BigInt(const std::string& str);
+    // Parses a view without copying it. Only std::string_view itself binds
+    // here, so string literals keep using the std::string constructor
+    // rather than becoming ambiguous.
+    template <typename StringView,
+              typename = std::enable_if_t<std::is_same<StringView, std::string_view>::value>>
+    explicit BigInt(StringView str) : negative(false) {
+        assignDigits(str.data(), str.data() + str.size(), 10);
+    }
+    // Digits 0-9 then a-z or A-Z in bases 2 to 36, with an optional sign and
+    // no prefix. Power-of-two bases are unpacked bit by bit in linear time.
+    BigInt(std::string_view str, int base);
     BigInt(long long num);
+#if defined(__SIZEOF_INT128__)
+    // __int128 and unsigned __int128, converted exactly.
+    template <typename Wide, EnableIfWide<Wide>* = nullptr>
+    BigInt(Wide value) : negative(std::is_same<Wide, __int128>::value && value < Wide(0)) {
+        unsigned __int128 magnitude = static_cast<unsigned __int128>(value);
+        if (negative) {
+            magnitude = 0 - magnitude;
+        }
+        for (; magnitude; magnitude >>= 64) {
+            limbs.push_back(static_cast<uint64_t>(magnitude));
+        }
+    }
+#endif
     BigInt(const BigInt& other);
     BigInt(BigInt&& other) noexcept;
     
-    // Assignment operators
+    // Assignment operators. Move assignment is not noexcept: when the two
+    // values' limb storage comes from different memory resources, as across
+    // a PoolScope boundary, it copies the limbs and can throw std::bad_alloc.
+    // std::is_nothrow_move_assignable<BigInt> is therefore false, and
+    // std::swap on BigInt is not noexcept; the move constructor still is.
     BigInt& operator=(const BigInt& other);
-    BigInt& operator=(BigInt&& other) noexcept;
+    BigInt& operator=(BigInt&& other);
     BigInt& operator=(long long num);
     
     // Arithmetic operators
@@ -73,6 +175,36 @@ public:
     BigInt operator%(const BigInt& other) const;
     BigInt operator^(const BigInt& other) const; // Power
     
+    // Quotient and remainder from a single division. Truncate rounds the
+    // quotient toward zero (as operator/ and operator% do), Floor toward
+    // negative infinity (remainder takes the divisor's sign) and Euclidean
+    // keeps the remainder non-negative. The output overload reuses the
+    // storage already held by quotient and remainder. Either output may be
+    // the dividend or the divisor, but quotient and remainder must be
+    // different objects (InvalidInputException otherwise).
+    enum class DivisionMode { Truncate, Floor, Euclidean };
+    static std::pair<BigInt, BigInt> divmod(const BigInt& dividend, const BigInt& divisor,
+                                            DivisionMode mode = DivisionMode::Truncate);
+    static void divmod(const BigInt& dividend, const BigInt& divisor, BigInt& quotient,
+                       BigInt& remainder, DivisionMode mode = DivisionMode::Truncate);
+    
+    // Fused kernels. multiplyAdd and multiplySubtract compute accumulator +=
+    // a * b and accumulator -= a * b, adding short products row by row
+    // straight into the accumulator; multiplyMod computes (a * b) % modulus
+    // with operator%'s sign rule. None creates an intermediate BigInt, and
+    // the output may be the same object as any operand.
+    static void multiplyAdd(BigInt& accumulator, const BigInt& a, const BigInt& b);
+    static void multiplySubtract(BigInt& accumulator, const BigInt& a, const BigInt& b);
+    static void multiplyMod(const BigInt& a, const BigInt& b, const BigInt& modulus,
+                            BigInt& result);
+    
+    // Modular arithmetic against a fixed modulus, defined below.
+    class ModContext;
+    struct FactorizationProgress;
+    // Called periodically by long-running operations; returning false
+    // cancels the operation, which then throws OperationCancelledException.
+    using ProgressCallback = std::function<bool(const FactorizationProgress&)>;
+    
     // Compound assignment operators
     BigInt& operator+=(const BigInt& other);
     BigInt& operator-=(const BigInt& other);
@@ -81,6 +213,65 @@ public:
     BigInt& operator%=(const BigInt& other);
     BigInt& operator^=(const BigInt& other);
     
+    // Native integer operands of any integral type but bool run single-limb
+    // kernels on the value's magnitude, with no temporary BigInt. They follow
+    // the BigInt operators: / and % truncate, and a zero divisor throws
+    // DivisionByZeroException.
+    template <typename Native, typename = EnableIfNative<Native>>
+    BigInt& operator+=(Native value) {
+        addNative(nativeMagnitude(value), isNativeNegative(value));
+        return *this;
+    }
+    template <typename Native, typename = EnableIfNative<Native>>
+    BigInt& operator-=(Native value) {
+        addNative(nativeMagnitude(value), !isNativeNegative(value));
+        return *this;
+    }
+    template <typename Native, typename = EnableIfNative<Native>>
+    BigInt& operator*=(Native value) {
+        multiplyNative(nativeMagnitude(value), isNativeNegative(value));
+        return *this;
+    }
+    template <typename Native, typename = EnableIfNative<Native>>
+    BigInt& operator/=(Native value) {
+        divideNative(nativeMagnitude(value), isNativeNegative(value));
+        return *this;
+    }
+    template <typename Native, typename = EnableIfNative<Native>>
+    BigInt& operator%=(Native value) {
+        remainderNative(nativeMagnitude(value));
+        return *this;
+    }
+    template <typename Native, typename = EnableIfNative<Native>>
+    BigInt operator+(Native value) const {
+        BigInt result(*this);
+        return result += value;
+    }
+    template <typename Native, typename = EnableIfNative<Native>>
+    BigInt operator-(Native value) const {
+        BigInt result(*this);
+        return result -= value;
+    }
+    template <typename Native, typename = EnableIfNative<Native>>
+    BigInt operator*(Native value) const {
+        BigInt result(*this);
+        return result *= value;
+    }
+    template <typename Native, typename = EnableIfNative<Native>>
+    BigInt operator/(Native value) const {
+        BigInt result(*this);
+        return result /= value;
+    }
+    template <typename Native, typename = EnableIfNative<Native>>
+    BigInt operator%(Native value) const {
+        BigInt result(*this);
+        return result %= value;
+    }
+    // divmod by a native divisor: the quotient goes to quotient, which may be
+    // dividend itself, and the remainder is returned, rounded as by mode.
+    static int64_t divmodSmall(const BigInt& dividend, int64_t divisor, BigInt& quotient,
+                               DivisionMode mode = DivisionMode::Truncate);
+    
     // Increment/Decrement operators
     BigInt& operator++();
     BigInt operator++(int);
@@ -99,45 +290,286 @@ public:
     BigInt operator-() const;
     BigInt operator+() const;
     
+    // Bitwise operators with two's complement semantics: a negative value
+    // acts as if sign-extended with infinitely many one bits, so ~x is
+    // -x - 1 and x >> k rounds toward negative infinity. operator^ is the
+    // power operator, so exclusive or is bitwiseXor. All run in linear time.
+    BigInt operator&(const BigInt& other) const;
+    BigInt operator|(const BigInt& other) const;
+    BigInt operator~() const;
+    BigInt operator<<(size_t bits) const;
+    BigInt operator>>(size_t bits) const;
+    BigInt& operator&=(const BigInt& other);
+    BigInt& operator|=(const BigInt& other);
+    BigInt& operator<<=(size_t bits);
+    BigInt& operator>>=(size_t bits);
+    static BigInt bitwiseXor(const BigInt& a, const BigInt& b);
+    
+    // Bits of the magnitude: bitLength is 0 for zero, popcount counts ones.
+    // testBit reads the two's complement bit, as the operators above do.
+    size_t bitLength() const;
+    bool testBit(size_t i) const;
+    size_t popcount() const;
+    
     // Utility methods
     bool isZero() const;
     bool isNegative() const;
     bool isPositive() const;
+    // Decimal digits of the magnitude, 1 for zero.
     int getDigitCount() const;
-    std::string toString() const;
+    // Digits 0-9 then a-z in bases 2 to 36, with no prefix. Power-of-two
+    // bases are a linear-time bit repack.
+    std::string toString(int base = 10) const;
     long long toLongLong() const;
     
     // Mathematical functions
+    // factorial, binomial and catalan multiply out prime factorizations as
+    // balanced product trees; factorial does so by Luschny's prime swing.
+    // Negative n throws InvalidInputException, and binomial is zero for k
+    // outside [0, n].
     static BigInt factorial(int n);
+    static BigInt binomial(int n, int k);
+    // Fibonacci and Lucas numbers by fast doubling, two squarings per bit of
+    // n. fibonacciPair returns F(n) and F(n + 1). All three throw
+    // InvalidInputException for negative n.
     static BigInt fibonacci(int n);
+    static std::pair<BigInt, BigInt> fibonacciPair(int n);
+    static BigInt lucas(int n);
     static BigInt catalan(int n);
+    // gcd and lcm are non-negative. Operands of two or more limbs go through
+    // Lehmer's algorithm, which advances Euclid's remainders many steps per
+    // pass from their leading bits; single limbs use binary GCD.
     static BigInt gcd(const BigInt& a, const BigInt& b);
     static BigInt lcm(const BigInt& a, const BigInt& b);
+    // Returns g = gcd(a, b) and sets x and y with a * x + b * y = g, taking
+    // |x| <= |b| / 2g when b is non-zero, and x = sign(a), y = 0 otherwise.
+    static BigInt extendedGcd(const BigInt& a, const BigInt& b, BigInt& x, BigInt& y);
+    // The inverse of a modulo m in [0, m). Throws InvalidInputException if m
+    // is not positive or a has no inverse.
+    static BigInt modInverse(const BigInt& a, const BigInt& m);
+    // Deterministic below 2^64 (Miller-Rabin with a fixed witness set) and
+    // Baillie-PSW above, after trial division by the primes below 4096.
     static bool isPrime(const BigInt& n);
-    static std::vector<std::pair<BigInt, int>> primeFactorization(const BigInt& n);
+    // Prime generation. Candidates are odd numbers sieved a window at a time
+    // by the primes below 4096, so most composites never reach a modular
+    // exponentiation. With threads > 1 the survivors of each window are
+    // tested by up to that many tasks on the shared pool, so no more run at
+    // once than setParallelPolicy allows; the result is the same.
+    // nextPrime returns the smallest prime above n. randomPrime draws a
+    // uniform odd start of exactly `bits` bits (at least 2) from rng and
+    // returns the next prime of that size, redrawing if the search would
+    // overflow it.
+    static BigInt nextPrime(const BigInt& n, unsigned threads = 1);
+    template <typename Rng>
+    static BigInt randomPrime(size_t bits, Rng& rng, unsigned threads = 1) {
+        std::uniform_int_distribution<uint64_t> limb;
+        return randomPrimeFrom(bits, [&rng, &limb] { return limb(rng); }, threads);
+    }
+    // Prime factors of |n| in increasing order with their multiplicities.
+    // Small factors come off by trial division (the sieve primes below 4096,
+    // then a 2-3-5-7 wheel up to 2^16); each cofactor is checked with isPrime
+    // and otherwise split by Pollard-Brent rho, in native arithmetic when it
+    // fits a limb, and then by ECM with growing bounds. progress, when set,
+    // is called between rho rounds and ECM curves.
+    static std::vector<std::pair<BigInt, int>> primeFactorization(
+        const BigInt& n, const ProgressCallback& progress = nullptr);
+    // Integer roots, rounded toward zero. sqrt works by precision doubling:
+    // the root of the top half of n, shifted into place, needs one Newton
+    // step from above. isqrtrem also returns n - root^2. nthRoot seeds
+    // Newton's iteration from the leading limbs; an odd root of a negative n
+    // is -nthRoot(-n, k), so nthRoot(-9, 3) is -2, and even ones throw
+    // InvalidInputException, as does k < 1.
     static BigInt sqrt(const BigInt& n);
+    static std::pair<BigInt, BigInt> isqrtrem(const BigInt& n);
+    static void isqrtrem(const BigInt& n, BigInt& root, BigInt& remainder);
+    static BigInt nthRoot(const BigInt& n, int k);
+    // Whether n = r^k for some integer r and k >= 2, reporting the largest
+    // such k and its root. 0 and 1 are squares, and -1 is a cube.
+    static bool isPerfectPower(const BigInt& n, BigInt* root = nullptr, int* exponent = nullptr);
     static BigInt pow(const BigInt& base, const BigInt& exponent);
+    static BigInt square(const BigInt& n);
     
-    // Performance and utility
+    // Performance and utility. Capacity and size count 64-bit limbs, not
+    // decimal digits: a limb holds over 19 digits, so reserve((d + 18) / 19)
+    // covers a d-digit value. getDigitCount() gives the decimal length.
     void reserve(size_t size);
     size_t size() const;
     void clear();
     
+    // Heap limb storage of BigInts constructed on the calling thread comes
+    // from this resource; null, the default, means global operator new.
+    static std::pmr::memory_resource* getMemoryResource();
+    static void setMemoryResource(std::pmr::memory_resource* resource);
+    
+    // Sends the calling thread's new limb buffers to a LimbPool while
+    // in scope and frees the whole pool at once on exit. Values created inside
+    // must not outlive the scope; assigning one to a BigInt declared outside
+    // copies it out.
+    class PoolScope {
+    public:
+        PoolScope();
+        ~PoolScope();
+        PoolScope(const PoolScope&) = delete;
+        PoolScope& operator=(const PoolScope&) = delete;
+        
+    private:
+        LimbPool pool;
+        std::pmr::memory_resource* previous;
+    };
+    
+    // Binary serialization in the versioned little-endian format described
+    // in BigIntSerialization.h. serialize writes serializedSize() bytes and
+    // throws InvalidInputException if capacity is smaller; deserialize reads
+    // one record from the front of [data, data + size), reporting its length
+    // through consumed, and throws InvalidInputException for malformed,
+    // non-canonical or truncated input.
+    size_t serializedSize() const;
+    size_t serialize(uint8_t* out, size_t capacity) const;
+    static BigInt deserialize(const uint8_t* data, size_t size, size_t* consumed = nullptr);
+    friend class BigIntReader;
+    friend class BigIntWriter;
+    friend class ConstantTimeInt;
+    friend class ConstantTimeModContext;
+    
     // Friend functions for I/O
     friend std::ostream& operator<<(std::ostream& os, const BigInt& num);
     friend std::istream& operator>>(std::istream& is, BigInt& num);
+    friend std::from_chars_result from_chars(const char* first, const char* last, BigInt& value,
+                                             int base);
+    friend std::to_chars_result to_chars(char* first, char* last, const BigInt& value, int base);
     
+    // Multiplication tuning. operator* uses schoolbook multiplication while the
+    // smaller operand is below `karatsuba` limbs, Karatsuba up to `toom3` limbs,
+    // Toom-3 up to `ntt` limbs and a three-prime number-theoretic transform
+    // beyond that. Below the NTT range, operands more than twice as long as the
+    // other are split into balanced blocks first. Squaring uses the same tiers.
+    // The initial karatsuba value is the crossover of the limb kernels in use
+    // (LimbKernels.h), 32 for the portable ones.
+    struct MultiplyThresholds {
+        size_t karatsuba = 32;
+        size_t toom3 = 250;
+        size_t ntt = 4000;
+    };
+    static MultiplyThresholds getMultiplyThresholds();
+    static void setMultiplyThresholds(const MultiplyThresholds& thresholds);
+
+    // Parallel execution, off by default. With threads > 1, a shared pool of
+    // threads - 1 workers (ThreadPool.h) joins the calling thread on large
+    // operations: Karatsuba, Toom-3 and NTT sub-products of operands of at
+    // least minLimbs limbs, the product trees behind factorial, binomial and
+    // catalan, and the divide-and-conquer halves of radix conversion.
+    // Smaller work stays serial, and results do not depend on the policy.
+    // threads = 0 means std::thread::hardware_concurrency(). The policy is
+    // process-wide and must not be changed while other threads compute.
+    struct ParallelPolicy {
+        unsigned threads = 1;
+        size_t minLimbs = 1000;
+    };
+    static ParallelPolicy getParallelPolicy();
+    static void setParallelPolicy(const ParallelPolicy& policy);
+
     // Constants
     static const BigInt ZERO;
     static const BigInt ONE;
     static const BigInt TWO;
 };
 
+// Modular arithmetic against a fixed positive modulus, with the reduction
+// constants computed once. Odd moduli up to MONTGOMERY_LIMIT limbs use
+// Montgomery multiplication; even or larger moduli use Barrett reduction.
+// Results are always in [0, modulus). modPow uses sliding windows over
+// the exponent's bits and throws InvalidInputException for negative
+// exponents.
+class BigInt::ModContext {
+public:
+    static constexpr size_t MONTGOMERY_LIMIT = 128;
+    
+    explicit ModContext(const BigInt& modulus);
+    
+    const BigInt& modulus() const { return mod; }
+    bool usesMontgomery() const { return montgomery; }
+    
+    BigInt reduce(const BigInt& x) const;
+    BigInt multiply(const BigInt& a, const BigInt& b) const;
+    BigInt square(const BigInt& a) const;
+    BigInt modPow(const BigInt& base, const BigInt& exponent) const;
+    
+    // Probable-prime tests of an odd modulus n > 2: one Miller-Rabin round
+    // to the given base, and the strong Lucas test with P = 1 and
+    // Q = (1 - d) / 4 for a d whose Jacobi symbol (d / n) is -1.
+    bool isStrongProbablePrime(const BigInt& base) const;
+    bool isStrongLucasProbablePrime(long long d) const;
+    
+    // A value in the working representation, for long chains of arithmetic
+    // that skip the conversions multiply() and square() pay on every call.
+    // Only meaningful with the context that produced it. The operations
+    // below accept aliased arguments.
+    class Residue {
+    private:
+        friend class ModContext;
+        LimbVector limbs;
+    };
+    
+    Residue toResidue(const BigInt& x) const;
+    BigInt fromResidue(const Residue& x) const;
+    void add(Residue& r, const Residue& a, const Residue& b) const;
+    void subtract(Residue& r, const Residue& a, const Residue& b) const;
+    void multiply(Residue& r, const Residue& a, const Residue& b) const;
+    bool isZero(const Residue& x) const;
+    
+private:
+    BigInt mod;
+    bool montgomery;
+    // Montgomery: -mod^-1 mod 2^64 and R^2 mod m for R = 2^(64n), padded to
+    // n limbs. Barrett: mu = floor(2^(128n) / mod).
+    uint64_t inverse;
+    LimbVector rSquared;
+    LimbVector mu;
+    
+    // Working representation: Montgomery form padded to n limbs, or the
+    // plain trimmed residue for Barrett.
+    void toDomain(const BigInt& x, LimbVector& r) const;
+    BigInt fromDomain(const LimbVector& x) const;
+    // r = a * b in the working representation; r may alias a or b.
+    void multiplyDomain(LimbVector& r, const LimbVector& a, const LimbVector& b,
+                        LimbVector& scratch) const;
+    void montgomeryReduce(LimbVector& r, LimbVector& t) const;
+    void barrettReduce(LimbVector& x) const;
+};
+
+// Reported to a primeFactorization progress callback.
+struct BigInt::FactorizationProgress {
+    enum Stage { TRIAL_DIVISION, POLLARD_RHO, ECM };
+    
+    Stage stage;
+    // The cofactor currently being split.
+    BigInt composite;
+    // Rho iterations, or ECM curves, spent on composite so far.
+    uint64_t work;
+    // ECM stage 1 bound of the current curve, or zero.
+    uint64_t bound;
+    // Prime factors found so far, counted with multiplicity.
+    size_t factorsFound;
+};
+
 // Non-member functions
 BigInt abs(const BigInt& num);
 BigInt min(const BigInt& a, const BigInt& b);
 BigInt max(const BigInt& a, const BigInt& b);
 
+// std::from_chars and std::to_chars counterparts for bases 2 to 36. from_chars
+// accepts an optional '-' followed by digits and stops at the first other
+// character, leaving value untouched and returning invalid_argument when no
+// digits are found. to_chars returns value_too_large when [first, last) is
+// too short, and bases outside 2 to 36 throw InvalidInputException. Neither
+// builds an intermediate string: power-of-two bases, and other bases up to 64
+// limb-sized chunks (about 1200 decimal digits), work only in value's storage,
+// the output buffer and reused per-thread scratch, while longer numbers also
+// need working limbs for their divide-and-conquer splits.
+std::from_chars_result from_chars(const char* first, const char* last, BigInt& value,
+                                  int base = 10);
+std::to_chars_result to_chars(char* first, char* last, const BigInt& value, int base = 10);
+
 // Literal operator for BigInt
 BigInt operator""_bigint(const char* str, size_t size);
 
@@ -0,0 +1,225 @@
+#ifndef BIGINT_EXPR_H
+#define BIGINT_EXPR_H
+
+#include "BigInt.h"
+#include <algorithm>
+#include <utility>
+
+// Opt-in expression templates for BigInt. Wrapping an operand in
+// BigIntExpr::lazy() makes +, -, * and % build an expression instead of a
+// value; the expression is evaluated once when it is assigned, into storage
+// sized up front. The operators are found by argument-dependent lookup, so
+// only lazy itself needs qualifying:
+//
+//     BigInt r = BigIntExpr::lazy(a) * b + BigIntExpr::lazy(c) * d - e;
+//     BigIntExpr::assign(r, BigIntExpr::lazy(r) * b % modulus);
+//
+// Products inside sums and differences accumulate straight into the result
+// through BigInt::multiplyAdd and BigInt::multiplySubtract, and a product
+// taken modulo a value uses BigInt::multiplyMod, so such chains create no
+// intermediate BigInt. Other shapes still evaluate their operands into
+// temporaries. Expressions hold references to their operands and must be
+// evaluated within the full expression that builds them.
+namespace BigIntExpr {
+
+template <typename Derived>
+struct Expression {
+    const Derived& self() const { return static_cast<const Derived&>(*this); }
+
+    operator BigInt() const {
+        BigInt result;
+        result.reserve(self().limbBound());
+        self().evaluateInto(result);
+        return result;
+    }
+};
+
+// A BigInt operand, held by reference.
+struct Leaf : Expression<Leaf> {
+    const BigInt& value;
+
+    explicit Leaf(const BigInt& value) : value(value) {}
+
+    size_t limbBound() const { return value.size(); }
+    bool refersTo(const BigInt* target) const { return &value == target; }
+    void evaluateInto(BigInt& out) const { out = value; }
+    void accumulateInto(BigInt& out, bool subtract) const {
+        if (subtract) {
+            out -= value;
+        } else {
+            out += value;
+        }
+    }
+};
+
+// The value of an operand as a BigInt: leaves are used in place, anything
+// else is evaluated into owned storage.
+template <typename E>
+class Materialized {
+public:
+    explicit Materialized(const E& expr) : value(expr) {}
+    const BigInt& get() const { return value; }
+
+private:
+    BigInt value;
+};
+
+template <>
+class Materialized<Leaf> {
+public:
+    explicit Materialized(const Leaf& leaf) : value(leaf.value) {}
+    const BigInt& get() const { return value; }
+
+private:
+    const BigInt& value;
+};
+
+template <typename L, typename R>
+struct Add : Expression<Add<L, R>> {
+    L left;
+    R right;
+
+    Add(const L& left, const R& right) : left(left), right(right) {}
+
+    size_t limbBound() const { return std::max(left.limbBound(), right.limbBound()) + 1; }
+    bool refersTo(const BigInt* target) const {
+        return left.refersTo(target) || right.refersTo(target);
+    }
+    void evaluateInto(BigInt& out) const {
+        left.evaluateInto(out);
+        right.accumulateInto(out, false);
+    }
+    void accumulateInto(BigInt& out, bool subtract) const {
+        left.accumulateInto(out, subtract);
+        right.accumulateInto(out, subtract);
+    }
+};
+
+template <typename L, typename R>
+struct Sub : Expression<Sub<L, R>> {
+    L left;
+    R right;
+
+    Sub(const L& left, const R& right) : left(left), right(right) {}
+
+    size_t limbBound() const { return std::max(left.limbBound(), right.limbBound()) + 1; }
+    bool refersTo(const BigInt* target) const {
+        return left.refersTo(target) || right.refersTo(target);
+    }
+    void evaluateInto(BigInt& out) const {
+        left.evaluateInto(out);
+        right.accumulateInto(out, true);
+    }
+    void accumulateInto(BigInt& out, bool subtract) const {
+        left.accumulateInto(out, subtract);
+        right.accumulateInto(out, !subtract);
+    }
+};
+
+template <typename L, typename R>
+struct Mul : Expression<Mul<L, R>> {
+    L left;
+    R right;
+
+    Mul(const L& left, const R& right) : left(left), right(right) {}
+
+    size_t limbBound() const { return left.limbBound() + right.limbBound(); }
+    bool refersTo(const BigInt* target) const {
+        return left.refersTo(target) || right.refersTo(target);
+    }
+    void evaluateInto(BigInt& out) const {
+        Materialized<L> x(left);
+        Materialized<R> y(right);
+        out = x.get();
+        out *= y.get();
+    }
+    void accumulateInto(BigInt& out, bool subtract) const {
+        Materialized<L> x(left);
+        Materialized<R> y(right);
+        if (subtract) {
+            BigInt::multiplySubtract(out, x.get(), y.get());
+        } else {
+            BigInt::multiplyAdd(out, x.get(), y.get());
+        }
+    }
+};
+
+// out = value % modulus, fused with the multiplication when value is a product.
+template <typename E>
+void evaluateModInto(const E& value, const BigInt& modulus, BigInt& out) {
+    value.evaluateInto(out);
+    out %= modulus;
+}
+
+template <typename L, typename R>
+void evaluateModInto(const Mul<L, R>& product, const BigInt& modulus, BigInt& out) {
+    Materialized<L> x(product.left);
+    Materialized<R> y(product.right);
+    BigInt::multiplyMod(x.get(), y.get(), modulus, out);
+}
+
+template <typename L, typename R>
+struct Mod : Expression<Mod<L, R>> {
+    L left;
+    R right;
+
+    Mod(const L& left, const R& right) : left(left), right(right) {}
+
+    size_t limbBound() const { return std::min(left.limbBound(), right.limbBound()); }
+    bool refersTo(const BigInt* target) const {
+        return left.refersTo(target) || right.refersTo(target);
+    }
+    void evaluateInto(BigInt& out) const {
+        Materialized<R> modulus(right);
+        evaluateModInto(left, modulus.get(), out);
+    }
+    void accumulateInto(BigInt& out, bool subtract) const {
+        BigInt value;
+        evaluateInto(value);
+        Leaf(value).accumulateInto(out, subtract);
+    }
+};
+
+inline Leaf lazy(const BigInt& value) {
+    return Leaf(value);
+}
+
+// Evaluates expr into result, reusing result's storage. When result is also
+// an operand the expression is evaluated aside and moved in.
+template <typename E>
+BigInt& assign(BigInt& result, const Expression<E>& expr) {
+    const E& e = expr.self();
+    if (e.refersTo(&result)) {
+        BigInt value = e;
+        result = std::move(value);
+        return result;
+    }
+    result.reserve(e.limbBound());
+    e.evaluateInto(result);
+    return result;
+}
+
+#define BIGINT_EXPR_OPERATOR(op, Node)                                           \
+    template <typename L, typename R>                                            \
+    Node<L, R> operator op(const Expression<L>& left, const Expression<R>& right) { \
+        return Node<L, R>(left.self(), right.self());                            \
+    }                                                                            \
+    template <typename L>                                                        \
+    Node<L, Leaf> operator op(const Expression<L>& left, const BigInt& right) {  \
+        return Node<L, Leaf>(left.self(), Leaf(right));                          \
+    }                                                                            \
+    template <typename R>                                                        \
+    Node<Leaf, R> operator op(const BigInt& left, const Expression<R>& right) {  \
+        return Node<Leaf, R>(Leaf(left), right.self());                          \
+    }
+
+BIGINT_EXPR_OPERATOR(+, Add)
+BIGINT_EXPR_OPERATOR(-, Sub)
+BIGINT_EXPR_OPERATOR(*, Mul)
+BIGINT_EXPR_OPERATOR(%, Mod)
+
+#undef BIGINT_EXPR_OPERATOR
+
+} // namespace BigIntExpr
+
+#endif // BIGINT_EXPR_H
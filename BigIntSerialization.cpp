@@ -0,0 +1,161 @@
+#include "BigIntSerialization.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+void storeLittleEndian(uint8_t* p, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        p[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint64_t loadLittleEndian(const uint8_t* p) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<uint64_t>(p[i]) << (8 * i);
+    }
+    return value;
+}
+
+void writeHeader(uint8_t* header, bool negative, uint64_t limbCount) {
+    std::memcpy(header, BigIntFormat::MAGIC, 4);
+    header[4] = BigIntFormat::VERSION;
+    header[5] = negative ? BigIntFormat::FLAG_NEGATIVE : 0;
+    header[6] = 0;
+    header[7] = 0;
+    storeLittleEndian(header + 8, limbCount);
+}
+
+// Validates a header and returns its limb count, setting negative.
+uint64_t readHeader(const uint8_t* header, bool& negative) {
+    if (std::memcmp(header, BigIntFormat::MAGIC, 4) != 0) {
+        throw InvalidInputException("Not a serialized BigInt");
+    }
+    if (header[4] != BigIntFormat::VERSION) {
+        throw InvalidInputException("Unsupported BigInt serialization version");
+    }
+    if ((header[5] & ~BigIntFormat::FLAG_NEGATIVE) != 0 || header[6] != 0 || header[7] != 0) {
+        throw InvalidInputException("Unknown flags in serialized BigInt");
+    }
+    negative = (header[5] & BigIntFormat::FLAG_NEGATIVE) != 0;
+    uint64_t limbCount = loadLittleEndian(header + 8);
+    if (negative && limbCount == 0) {
+        throw InvalidInputException("Serialized BigInt is negative zero");
+    }
+    return limbCount;
+}
+
+} // namespace
+
+// Binary serialization
+size_t BigInt::serializedSize() const {
+    return BigIntFormat::HEADER_BYTES + limbs.size() * sizeof(uint64_t);
+}
+
+size_t BigInt::serialize(uint8_t* out, size_t capacity) const {
+    size_t bytes = serializedSize();
+    if (capacity < bytes) {
+        throw InvalidInputException("Buffer too small for serialized BigInt");
+    }
+
+    writeHeader(out, negative, limbs.size());
+    uint8_t* p = out + BigIntFormat::HEADER_BYTES;
+    for (size_t i = 0; i < limbs.size(); ++i, p += sizeof(uint64_t)) {
+        storeLittleEndian(p, limbs[i]);
+    }
+    return bytes;
+}
+
+BigInt BigInt::deserialize(const uint8_t* data, size_t size, size_t* consumed) {
+    if (size < BigIntFormat::HEADER_BYTES) {
+        throw InvalidInputException("Truncated serialized BigInt");
+    }
+
+    bool sign = false;
+    uint64_t limbCount = readHeader(data, sign);
+    size_t available = (size - BigIntFormat::HEADER_BYTES) / sizeof(uint64_t);
+    if (limbCount > available) {
+        throw InvalidInputException("Truncated serialized BigInt");
+    }
+
+    BigInt result;
+    result.limbs.resize(static_cast<size_t>(limbCount));
+    const uint8_t* p = data + BigIntFormat::HEADER_BYTES;
+    for (size_t i = 0; i < limbCount; ++i, p += sizeof(uint64_t)) {
+        result.limbs[i] = loadLittleEndian(p);
+    }
+    if (limbCount != 0 && result.limbs.back() == 0) {
+        throw InvalidInputException("Serialized BigInt has leading zero limbs");
+    }
+    result.negative = sign;
+
+    if (consumed) {
+        *consumed = BigIntFormat::HEADER_BYTES + static_cast<size_t>(limbCount) * sizeof(uint64_t);
+    }
+    return result;
+}
+
+// Streaming writer
+BigIntWriter::BigIntWriter(std::ostream& os, size_t chunkLimbs)
+    : os(os), buffer(std::max<size_t>(chunkLimbs, 1) * sizeof(uint64_t)) {}
+
+void BigIntWriter::write(const BigInt& value) {
+    uint8_t header[BigIntFormat::HEADER_BYTES];
+    writeHeader(header, value.negative, value.limbs.size());
+    os.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    size_t chunkLimbs = buffer.size() / sizeof(uint64_t);
+    for (size_t start = 0; start < value.limbs.size(); start += chunkLimbs) {
+        size_t count = std::min(chunkLimbs, value.limbs.size() - start);
+        for (size_t i = 0; i < count; ++i) {
+            storeLittleEndian(&buffer[i * sizeof(uint64_t)], value.limbs[start + i]);
+        }
+        os.write(reinterpret_cast<const char*>(buffer.data()),
+                 static_cast<std::streamsize>(count * sizeof(uint64_t)));
+    }
+}
+
+// Streaming reader
+BigIntReader::BigIntReader(std::istream& is, size_t chunkLimbs)
+    : is(is), buffer(std::max<size_t>(chunkLimbs, 1) * sizeof(uint64_t)) {}
+
+bool BigIntReader::read(BigInt& value) {
+    uint8_t header[BigIntFormat::HEADER_BYTES];
+    is.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (is.gcount() == 0 && is.eof()) {
+        return false;
+    }
+    if (static_cast<size_t>(is.gcount()) != sizeof(header)) {
+        throw InvalidInputException("Truncated serialized BigInt");
+    }
+
+    bool sign = false;
+    uint64_t limbCount = readHeader(header, sign);
+
+    LimbVector& limbs = value.limbs;
+    limbs.clear();
+    size_t chunkLimbs = buffer.size() / sizeof(uint64_t);
+    while (limbs.size() < limbCount) {
+        size_t count = static_cast<size_t>(std::min<uint64_t>(chunkLimbs, limbCount - limbs.size()));
+        size_t bytes = count * sizeof(uint64_t);
+        is.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(bytes));
+        if (static_cast<size_t>(is.gcount()) != bytes) {
+            value.clear();
+            throw InvalidInputException("Truncated serialized BigInt");
+        }
+
+        size_t start = limbs.size();
+        limbs.resize(start + count);
+        for (size_t i = 0; i < count; ++i) {
+            limbs[start + i] = loadLittleEndian(&buffer[i * sizeof(uint64_t)]);
+        }
+    }
+
+    if (!limbs.empty() && limbs.back() == 0) {
+        value.clear();
+        throw InvalidInputException("Serialized BigInt has leading zero limbs");
+    }
+    value.negative = sign;
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef BIGINT_SERIALIZATION_H
+#define BIGINT_SERIALIZATION_H
+
+#include "BigInt.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// Binary format, version 1. Every field is little-endian:
+//
+//     offset  size  field
+//          0     4  magic "BIGN"
+//          4     1  version (1)
+//          5     1  flags: bit 0 set for negative values, other bits zero
+//          6     2  reserved, zero
+//          8     8  limb count n
+//         16    8n  magnitude as 64-bit limbs, least significant first
+//
+// Records are canonical: the top limb is non-zero and zero is n = 0 with no
+// sign. The header is a multiple of 8 bytes and so is every record, so
+// records packed back to back in an 8-byte aligned mapping keep their limbs
+// aligned. Readers bounds-check the length prefix before touching any limb
+// and never assume alignment themselves.
+namespace BigIntFormat {
+
+const uint8_t MAGIC[4] = {'B', 'I', 'G', 'N'};
+const uint8_t VERSION = 1;
+const uint8_t FLAG_NEGATIVE = 1;
+const size_t HEADER_BYTES = 16;
+
+} // namespace BigIntFormat
+
+// Writes values to a stream as consecutive records, converting their limbs
+// through a fixed-size buffer so no serialized copy of a value is built.
+class BigIntWriter {
+public:
+    explicit BigIntWriter(std::ostream& os, size_t chunkLimbs = 8192);
+
+    void write(const BigInt& value);
+
+private:
+    std::ostream& os;
+    std::vector<uint8_t> buffer;
+};
+
+// Reads records written by BigIntWriter or BigInt::serialize. Limbs are read
+// chunk by chunk into the destination, which grows only as data actually
+// arrives, so a corrupt length cannot trigger a huge allocation up front.
+class BigIntReader {
+public:
+    explicit BigIntReader(std::istream& is, size_t chunkLimbs = 8192);
+
+    // Returns false at a clean end of stream before the next record. Throws
+    // InvalidInputException for malformed or truncated records.
+    bool read(BigInt& value);
+
+private:
+    std::istream& is;
+    std::vector<uint8_t> buffer;
+};
+
+#endif // BIGINT_SERIALIZATION_H
@@ -0,0 +1,317 @@
+#include "BigIntStats.h"
+#include <atomic>
+#include <climits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+static_assert(static_cast<size_t>(BigIntStats::Operation::DivideNewton) + 1 ==
+                  BigIntStats::OPERATION_COUNT,
+              "OPERATION_COUNT must cover every operation");
+
+const char* BigIntStats::name(Operation operation) {
+    static const char* const NAMES[OPERATION_COUNT] = {
+        "add", "subtract", "multiply", "divide", "mod_pow", "gcd", "to_string", "parse",
+        "is_prime", "factorize", "multiply.schoolbook", "multiply.karatsuba",
+        "multiply.toom3", "multiply.ntt", "divide.single_limb", "divide.knuth",
+        "divide.newton"};
+    return NAMES[static_cast<size_t>(operation)];
+}
+
+#ifdef BIGINT_INSTRUMENTATION
+
+namespace {
+
+// Counter slots: one per operation, then one for allocations made while no
+// operation is running.
+const size_t OUTSIDE = BigIntStats::OPERATION_COUNT;
+const size_t SLOTS = OUTSIDE + 1;
+
+enum Field { CALLS, LIMBS, NANOSECONDS, ALLOCATIONS, ALLOCATED_BYTES, HISTOGRAM };
+const size_t FIELDS = HISTOGRAM + BigIntStats::SIZE_BUCKETS;
+
+struct RawCounters {
+    uint64_t values[SLOTS][FIELDS] = {};
+};
+
+// One thread's counters. Only the owning thread writes them, so an increment
+// is a relaxed load and store rather than a locked read-modify-write; the
+// atomics just let snapshot() read them concurrently.
+struct ThreadCounters {
+    std::atomic<uint64_t> values[SLOTS][FIELDS];
+
+    ThreadCounters() {
+        for (auto& slot : values) {
+            for (auto& value : slot) {
+                value.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void add(size_t slot, size_t field, uint64_t amount) {
+        std::atomic<uint64_t>& value = values[slot][field];
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadCounters*> threads;
+    // Counters of exited threads, and the totals reset() last saw.
+    RawCounters retired;
+    RawCounters baseline;
+    std::shared_ptr<BigIntStats::Callback> callback;
+    int64_t interval = 0;
+};
+
+// Leaked, so threads that exit during static destruction can still retire
+// their counters.
+Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+std::atomic<bool> recording{true};
+
+// Steady-clock time at which the callback is next due; LLONG_MAX while none
+// is set, so the check in ~Scope() is a single relaxed load.
+std::atomic<int64_t> callbackDue{LLONG_MAX};
+
+thread_local ThreadCounters* threadCounters = nullptr;
+thread_local bool threadExited = false;
+// Slot of the innermost operation running on this thread.
+thread_local size_t currentSlot = OUTSIDE;
+thread_local bool inCallback = false;
+
+// Folds the thread's counters into the retired totals when it exits.
+struct ThreadCountersOwner {
+    ~ThreadCountersOwner() {
+        if (!threadCounters) {
+            return;
+        }
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (size_t slot = 0; slot < SLOTS; ++slot) {
+            for (size_t field = 0; field < FIELDS; ++field) {
+                r.retired.values[slot][field] +=
+                    threadCounters->values[slot][field].load(std::memory_order_relaxed);
+            }
+        }
+        for (size_t i = 0; i < r.threads.size(); ++i) {
+            if (r.threads[i] == threadCounters) {
+                r.threads[i] = r.threads.back();
+                r.threads.pop_back();
+                break;
+            }
+        }
+        delete threadCounters;
+        threadCounters = nullptr;
+        threadExited = true;
+    }
+};
+
+thread_local ThreadCountersOwner threadCountersOwner;
+
+// The calling thread's counters, created on first use; null once the thread
+// has begun exiting.
+ThreadCounters* countersForThread() {
+    if (threadCounters || threadExited) {
+        return threadCounters;
+    }
+    // Taking the owner's address constructs it, scheduling its destructor.
+    static_cast<void>(&threadCountersOwner);
+    ThreadCounters* counters = new ThreadCounters();
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.threads.push_back(counters);
+    threadCounters = counters;
+    return counters;
+}
+
+// Sum of every thread's counters, live and retired. Requires r.mutex.
+RawCounters totals(Registry& r) {
+    RawCounters sum = r.retired;
+    for (const ThreadCounters* counters : r.threads) {
+        for (size_t slot = 0; slot < SLOTS; ++slot) {
+            for (size_t field = 0; field < FIELDS; ++field) {
+                sum.values[slot][field] += counters->values[slot][field].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    return sum;
+}
+
+int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+size_t sizeBucket(size_t limbs) {
+    size_t bucket = 0;
+    while (limbs && bucket + 1 < BigIntStats::SIZE_BUCKETS) {
+        limbs >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+// Runs the callback if it is due, claiming the interval under the registry
+// lock so only one thread publishes it.
+void publish(int64_t time) {
+    if (inCallback) {
+        return;
+    }
+    std::shared_ptr<BigIntStats::Callback> callback;
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!r.callback || time < callbackDue.load(std::memory_order_relaxed)) {
+            return;
+        }
+        callbackDue.store(time + r.interval, std::memory_order_relaxed);
+        callback = r.callback;
+    }
+    BigIntStats::Snapshot snapshot = BigIntStats::snapshot();
+    inCallback = true;
+    (*callback)(snapshot);
+    inCallback = false;
+}
+
+} // namespace
+
+bool BigIntStats::compiledIn() {
+    return true;
+}
+
+void BigIntStats::setEnabled(bool enabled) {
+    recording.store(enabled, std::memory_order_relaxed);
+}
+
+bool BigIntStats::isEnabled() {
+    return recording.load(std::memory_order_relaxed);
+}
+
+BigIntStats::Snapshot BigIntStats::snapshot() {
+    RawCounters sum;
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        sum = totals(r);
+        for (size_t slot = 0; slot < SLOTS; ++slot) {
+            for (size_t field = 0; field < FIELDS; ++field) {
+                sum.values[slot][field] -= r.baseline.values[slot][field];
+            }
+        }
+    }
+
+    Snapshot result;
+    for (size_t slot = 0; slot < SLOTS; ++slot) {
+        const uint64_t* values = sum.values[slot];
+        result.allocations += values[ALLOCATIONS];
+        result.allocatedBytes += values[ALLOCATED_BYTES];
+        if (slot == OUTSIDE) {
+            continue;
+        }
+        Counters& counters = result.operations[slot];
+        counters.calls = values[CALLS];
+        counters.limbs = values[LIMBS];
+        counters.nanoseconds = values[NANOSECONDS];
+        counters.allocations = values[ALLOCATIONS];
+        counters.allocatedBytes = values[ALLOCATED_BYTES];
+        for (size_t k = 0; k < SIZE_BUCKETS; ++k) {
+            counters.sizeHistogram[k] = values[HISTOGRAM + k];
+        }
+    }
+    return result;
+}
+
+void BigIntStats::reset() {
+    // Other threads own their counters, so rather than clearing them the
+    // current totals become the zero point.
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.baseline = totals(r);
+}
+
+void BigIntStats::setCallback(Callback callback, std::chrono::nanoseconds interval) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if (callback) {
+        r.callback = std::make_shared<Callback>(std::move(callback));
+        r.interval = interval.count();
+        callbackDue.store(now() + r.interval, std::memory_order_relaxed);
+    } else {
+        r.callback.reset();
+        callbackDue.store(LLONG_MAX, std::memory_order_relaxed);
+    }
+}
+
+BigIntStats::Scope::Scope(Operation operation, size_t limbs)
+    : operation(operation), limbs(limbs), active(recording.load(std::memory_order_relaxed)),
+      outer(currentSlot), start(0) {
+    if (active) {
+        currentSlot = static_cast<size_t>(operation);
+        start = now();
+    }
+}
+
+BigIntStats::Scope::~Scope() {
+    if (!active) {
+        return;
+    }
+    int64_t end = now();
+    currentSlot = outer;
+    if (ThreadCounters* counters = countersForThread()) {
+        size_t slot = static_cast<size_t>(operation);
+        counters->add(slot, CALLS, 1);
+        counters->add(slot, LIMBS, limbs);
+        counters->add(slot, NANOSECONDS, static_cast<uint64_t>(end - start));
+        counters->add(slot, HISTOGRAM + sizeBucket(limbs), 1);
+    }
+    if (end >= callbackDue.load(std::memory_order_relaxed)) {
+        publish(end);
+    }
+}
+
+void BigIntStats::recordAllocation(size_t bytes) {
+    if (!recording.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (ThreadCounters* counters = countersForThread()) {
+        counters->add(currentSlot, ALLOCATIONS, 1);
+        counters->add(currentSlot, ALLOCATED_BYTES, bytes);
+    }
+}
+
+#else
+
+// Without BIGINT_INSTRUMENTATION nothing records, and the API reports empty
+// counters.
+
+bool BigIntStats::compiledIn() {
+    return false;
+}
+
+void BigIntStats::setEnabled(bool) {}
+
+bool BigIntStats::isEnabled() {
+    return false;
+}
+
+BigIntStats::Snapshot BigIntStats::snapshot() {
+    return Snapshot();
+}
+
+void BigIntStats::reset() {}
+
+void BigIntStats::setCallback(Callback, std::chrono::nanoseconds) {}
+
+BigIntStats::Scope::Scope(Operation operation, size_t limbs)
+    : operation(operation), limbs(limbs), active(false), outer(0), start(0) {}
+
+BigIntStats::Scope::~Scope() {}
+
+void BigIntStats::recordAllocation(size_t) {}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef BIGINT_STATS_H
+#define BIGINT_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// Operation counters for BigInt, compiled in when BIGINT_INSTRUMENTATION is
+// defined (the CMake option of the same name). Without it the recording
+// hooks expand to nothing and snapshot() stays empty.
+//
+// Each operation and algorithm tier counts its calls, the limbs of its
+// operands, the limb buffers it allocates and the time it takes. Times are
+// inclusive, so an operator* call is timed both as Multiply and under the
+// tier that ran it, and recursive tiers count once per sub-product.
+// Allocations are charged to the innermost operation running on the thread.
+//
+// Recording is per thread and lock-free; snapshot() sums every thread's
+// counters, including those of threads that have exited.
+class BigIntStats {
+public:
+    enum class Operation {
+        Add, Subtract, Multiply, Divide, ModPow, Gcd, ToString, Parse, IsPrime, Factorize,
+        // Tiers of the multiplication kernel, squaring included.
+        MultiplySchoolbook, MultiplyKaratsuba, MultiplyToom3, MultiplyNtt,
+        // Tiers of the division kernel.
+        DivideSingleLimb, DivideKnuth, DivideNewton
+    };
+
+    static constexpr size_t OPERATION_COUNT = 17;
+
+    // sizeHistogram[k] counts the calls whose operands had 2^(k-1) to
+    // 2^k - 1 limbs; sizeHistogram[0] those with none.
+    static constexpr size_t SIZE_BUCKETS = 32;
+
+    struct Counters {
+        uint64_t calls = 0;
+        uint64_t limbs = 0;
+        uint64_t nanoseconds = 0;
+        uint64_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+        uint64_t sizeHistogram[SIZE_BUCKETS] = {};
+    };
+
+    struct Snapshot {
+        Counters operations[OPERATION_COUNT];
+        // Every limb buffer allocation, including those made outside any
+        // counted operation.
+        uint64_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+
+        const Counters& operator[](Operation operation) const {
+            return operations[static_cast<size_t>(operation)];
+        }
+    };
+
+    typedef std::function<void(const Snapshot&)> Callback;
+
+    // Whether this build records anything.
+    static bool compiledIn();
+
+    // Pauses or resumes recording on all threads; it starts enabled.
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    // Counters accumulated since the last reset().
+    static Snapshot snapshot();
+    static void reset();
+
+    // Calls callback with a fresh snapshot once per interval, on whichever
+    // thread finishes the first operation after the interval has elapsed.
+    // The callback must not throw; an empty callback removes it.
+    static void setCallback(Callback callback, std::chrono::nanoseconds interval);
+
+    // Stable dotted name for metric export, e.g. "multiply.karatsuba".
+    static const char* name(Operation operation);
+
+    // Times one operation on the calling thread. Use BIGINT_STATS_SCOPE.
+    class Scope {
+    public:
+        Scope(Operation operation, size_t limbs);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        // For operations whose size is only known once they finish.
+        void setLimbs(size_t count) { limbs = count; }
+
+    private:
+        Operation operation;
+        size_t limbs;
+        bool active;
+        size_t outer;
+        int64_t start;
+    };
+
+    // Counts a limb buffer allocation. Use BIGINT_STATS_ALLOCATION.
+    static void recordAllocation(size_t bytes);
+};
+
+#ifdef BIGINT_INSTRUMENTATION
+#define BIGINT_STATS_SCOPE(operation, limbs) \
+    BigIntStats::Scope bigIntStatsScope(BigIntStats::Operation::operation, limbs)
+#define BIGINT_STATS_LIMBS(limbs) bigIntStatsScope.setLimbs(limbs)
+#define BIGINT_STATS_ALLOCATION(bytes) BigIntStats::recordAllocation(bytes)
+#else
+#define BIGINT_STATS_SCOPE(operation, limbs) static_cast<void>(0)
+#define BIGINT_STATS_LIMBS(limbs) static_cast<void>(0)
+#define BIGINT_STATS_ALLOCATION(bytes) static_cast<void>(0)
+#endif
+
+#endif // BIGINT_STATS_H
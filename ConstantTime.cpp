@@ -0,0 +1,279 @@
+#include "ConstantTime.h"
+#include <algorithm>
+
+namespace {
+
+typedef uint64_t Limb;
+
+// All-ones when bit is 1, zero when it is 0.
+inline Limb maskFor(Limb bit) {
+    return 0 - bit;
+}
+
+// a + b + carry, with the carry computed from the operand bits.
+inline Limb addCarry(Limb a, Limb b, Limb& carry) {
+    Limb sum = a + b + carry;
+    carry = ((a & b) | ((a | b) & ~sum)) >> 63;
+    return sum;
+}
+
+// a - b - borrow, with the borrow computed from the operand bits.
+inline Limb subBorrow(Limb a, Limb b, Limb& borrow) {
+    Limb difference = a - b - borrow;
+    borrow = ((~a & b) | (~(a ^ b) & difference)) >> 63;
+    return difference;
+}
+
+// a * b + c + d, returning the low limb and setting high. Cannot overflow.
+inline Limb mulAdd(Limb a, Limb b, Limb c, Limb d, Limb& high) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 t = static_cast<unsigned __int128>(a) * b + c + d;
+    high = static_cast<Limb>(t >> 64);
+    return static_cast<Limb>(t);
+#else
+    Limb a0 = a & 0xFFFFFFFFULL, a1 = a >> 32;
+    Limb b0 = b & 0xFFFFFFFFULL, b1 = b >> 32;
+    Limb p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    Limb middle = (p00 >> 32) + (p01 & 0xFFFFFFFFULL) + (p10 & 0xFFFFFFFFULL);
+    Limb low = (p00 & 0xFFFFFFFFULL) | (middle << 32);
+    high = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+    Limb carry = 0;
+    low = addCarry(low, c, carry);
+    high += carry;
+    carry = 0;
+    low = addCarry(low, d, carry);
+    high += carry;
+    return low;
+#endif
+}
+
+// Overwrites memory in a way the compiler may not elide.
+void wipe(std::vector<Limb>& limbs) {
+    volatile Limb* p = limbs.data();
+    for (size_t i = 0; i < limbs.size(); ++i) {
+        p[i] = 0;
+    }
+}
+
+} // namespace
+
+// Constructors
+ConstantTimeInt::ConstantTimeInt(size_t limbCount) : limbs(limbCount, 0) {}
+
+ConstantTimeInt::ConstantTimeInt(const BigInt& value, size_t limbCount) : limbs(limbCount, 0) {
+    if (value.isNegative()) {
+        throw InvalidInputException("Constant-time values must be non-negative");
+    }
+    if (value.limbs.size() > limbCount) {
+        throw InvalidInputException("Value does not fit the constant-time width");
+    }
+    std::copy(value.limbs.begin(), value.limbs.end(), limbs.begin());
+}
+
+ConstantTimeInt& ConstantTimeInt::operator=(const ConstantTimeInt& other) {
+    if (this != &other) {
+        if (other.limbs.size() != limbs.size()) {
+            wipe(limbs);
+        }
+        limbs = other.limbs;
+    }
+    return *this;
+}
+
+ConstantTimeInt::~ConstantTimeInt() {
+    wipe(limbs);
+}
+
+BigInt ConstantTimeInt::toBigInt() const {
+    BigInt result;
+    result.limbs.assign(limbs.data(), limbs.data() + limbs.size());
+    result.normalize();
+    return result;
+}
+
+uint64_t ConstantTimeInt::add(const ConstantTimeInt& other) {
+    Limb carry = 0;
+    for (size_t i = 0; i < limbs.size(); ++i) {
+        limbs[i] = addCarry(limbs[i], other.limbs[i], carry);
+    }
+    return carry;
+}
+
+uint64_t ConstantTimeInt::subtract(const ConstantTimeInt& other) {
+    Limb borrow = 0;
+    for (size_t i = 0; i < limbs.size(); ++i) {
+        limbs[i] = subBorrow(limbs[i], other.limbs[i], borrow);
+    }
+    return borrow;
+}
+
+uint64_t ConstantTimeInt::less(const ConstantTimeInt& a, const ConstantTimeInt& b) {
+    Limb borrow = 0;
+    for (size_t i = 0; i < a.limbs.size(); ++i) {
+        subBorrow(a.limbs[i], b.limbs[i], borrow);
+    }
+    return borrow;
+}
+
+int ConstantTimeInt::compare(const ConstantTimeInt& a, const ConstantTimeInt& b) {
+    return static_cast<int>(less(b, a)) - static_cast<int>(less(a, b));
+}
+
+ConstantTimeInt ConstantTimeInt::select(uint64_t condition, const ConstantTimeInt& a,
+                                        const ConstantTimeInt& b) {
+    ConstantTimeInt result(a.limbs.size());
+    Limb mask = maskFor(condition);
+    for (size_t i = 0; i < a.limbs.size(); ++i) {
+        result.limbs[i] = b.limbs[i] ^ (mask & (a.limbs[i] ^ b.limbs[i]));
+    }
+    return result;
+}
+
+void ConstantTimeInt::conditionalSwap(uint64_t condition, ConstantTimeInt& a, ConstantTimeInt& b) {
+    Limb mask = maskFor(condition);
+    for (size_t i = 0; i < a.limbs.size(); ++i) {
+        Limb t = mask & (a.limbs[i] ^ b.limbs[i]);
+        a.limbs[i] ^= t;
+        b.limbs[i] ^= t;
+    }
+}
+
+// Constant-time modular context
+ConstantTimeModContext::ConstantTimeModContext(const BigInt& m)
+    : modulus(m.isNegative() ? 0 : m.size()), one(m.size()), rSquared(m.size()), inverse(0) {
+    if (m.isNegative() || m <= BigInt::ONE || m.limbs[0] % 2 == 0) {
+        throw InvalidInputException("Constant-time modulus must be odd and greater than 1");
+    }
+    modulus = ConstantTimeInt(m, m.size());
+
+    // The modulus is public, so its constants come from the ordinary
+    // variable-time operations.
+    size_t n = m.size();
+    BigInt r;
+    r.limbs.assign(n + 1, 0);
+    r.limbs[n] = 1;
+    one = ConstantTimeInt(r % m, n);
+    rSquared = ConstantTimeInt((r * r) % m, n);
+
+    Limb m0 = m.limbs[0];
+    Limb x = m0;
+    for (int i = 0; i < 5; ++i) {
+        x *= 2 - m0 * x;
+    }
+    inverse = 0 - x;
+}
+
+// Coarsely integrated operand scanning: each row multiplies in one limb of b
+// and immediately divides by 2^64, keeping t below 2m in n + 2 limbs. The
+// final subtraction of m is always computed and kept or discarded by mask.
+// t and the reduced copy live in the caller's scratch, so the ladder
+// allocates nothing per step.
+void ConstantTimeModContext::montgomeryMultiply(uint64_t* r, const uint64_t* a,
+                                                const uint64_t* b, uint64_t* scratch) const {
+    size_t n = modulus.limbCount();
+    const Limb* m = modulus.limbs.data();
+    Limb* t = scratch;
+    Limb* reduced = scratch + n + 2;
+    std::fill(t, t + n + 2, Limb(0));
+
+    for (size_t i = 0; i < n; ++i) {
+        Limb carry = 0;
+        for (size_t j = 0; j < n; ++j) {
+            t[j] = mulAdd(a[j], b[i], t[j], carry, carry);
+        }
+        Limb bit = 0;
+        t[n] = addCarry(t[n], carry, bit);
+        t[n + 1] = bit;
+
+        Limb u = t[0] * inverse;
+        mulAdd(u, m[0], t[0], 0, carry);
+        for (size_t j = 1; j < n; ++j) {
+            t[j - 1] = mulAdd(u, m[j], t[j], carry, carry);
+        }
+        bit = 0;
+        t[n - 1] = addCarry(t[n], carry, bit);
+        t[n] = t[n + 1] + bit;
+    }
+
+    Limb borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        reduced[i] = subBorrow(t[i], m[i], borrow);
+    }
+    subBorrow(t[n], 0, borrow);
+    // borrow is 1 exactly when t < m, in which case t is kept.
+    Limb keep = maskFor(borrow);
+    for (size_t i = 0; i < n; ++i) {
+        r[i] = reduced[i] ^ (keep & (t[i] ^ reduced[i]));
+    }
+}
+
+// a = a + b mod m for a, b < m. Both the sum and the sum less m are formed;
+// the sum is kept when subtracting m borrows without the addition carrying.
+void ConstantTimeModContext::addModulo(ConstantTimeInt& a, const ConstantTimeInt& b) const {
+    ConstantTimeInt sum = a;
+    Limb carry = sum.add(b);
+    ConstantTimeInt difference = sum;
+    Limb borrow = difference.subtract(modulus);
+    a = ConstantTimeInt::select(borrow & (carry ^ 1), sum, difference);
+}
+
+// Folds value in n limbs at a time from the top, acc = acc * R + chunk mod m.
+// A Montgomery multiplication by R^2 mod m shifts acc up by R, and one by
+// R mod m reduces each chunk; their results are below m for any n-limb input.
+ConstantTimeInt ConstantTimeModContext::reduce(const BigInt& value) const {
+    size_t n = limbCount();
+    size_t chunks = std::max<size_t>(1, (value.size() + n - 1) / n);
+    ConstantTimeInt wide(value, chunks * n);
+    ConstantTimeInt acc(n), chunk(n), scratch(scratchLimbs(n));
+    for (size_t c = chunks; c-- > 0;) {
+        montgomeryMultiply(acc.limbs.data(), acc.limbs.data(), rSquared.limbs.data(),
+                           scratch.limbs.data());
+        montgomeryMultiply(chunk.limbs.data(), wide.limbs.data() + c * n, one.limbs.data(),
+                           scratch.limbs.data());
+        addModulo(acc, chunk);
+    }
+    return acc;
+}
+
+ConstantTimeInt ConstantTimeModContext::multiply(const ConstantTimeInt& a,
+                                                 const ConstantTimeInt& b) const {
+    ConstantTimeInt result(limbCount()), scratch(scratchLimbs(limbCount()));
+    montgomeryMultiply(result.limbs.data(), a.limbs.data(), b.limbs.data(), scratch.limbs.data());
+    montgomeryMultiply(result.limbs.data(), result.limbs.data(), rSquared.limbs.data(),
+                       scratch.limbs.data());
+    return result;
+}
+
+ConstantTimeInt ConstantTimeModContext::modPow(const ConstantTimeInt& base,
+                                               const ConstantTimeInt& exponent) const {
+    size_t n = limbCount();
+    ConstantTimeInt low = one;
+    ConstantTimeInt high(n), scratch(scratchLimbs(n));
+    Limb* work = scratch.limbs.data();
+    montgomeryMultiply(high.limbs.data(), base.limbs.data(), rSquared.limbs.data(), work);
+
+    // Invariant: high = low * base. A one bit multiplies low into high and
+    // squares high, a zero bit the reverse; the swaps pick which is which.
+    for (size_t i = exponent.limbCount() * 64; i-- > 0;) {
+        Limb bit = (exponent.limbs[i / 64] >> (i % 64)) & 1;
+        ConstantTimeInt::conditionalSwap(bit, low, high);
+        montgomeryMultiply(high.limbs.data(), low.limbs.data(), high.limbs.data(), work);
+        montgomeryMultiply(low.limbs.data(), low.limbs.data(), low.limbs.data(), work);
+        ConstantTimeInt::conditionalSwap(bit, low, high);
+    }
+
+    ConstantTimeInt unit(n);
+    unit.limbs[0] = 1;
+    ConstantTimeInt result(n);
+    montgomeryMultiply(result.limbs.data(), low.limbs.data(), unit.limbs.data(), work);
+    return result;
+}
+
+BigInt ConstantTimeModContext::modPow(const BigInt& base, const BigInt& exponent) const {
+    if (exponent.isNegative()) {
+        throw InvalidInputException("Negative exponent not supported");
+    }
+    ConstantTimeInt b = reduce(base);
+    ConstantTimeInt e(exponent, std::max(limbCount(), exponent.size()));
+    return modPow(b, e).toBigInt();
+}
@@ -0,0 +1,94 @@
+#ifndef CONSTANT_TIME_H
+#define CONSTANT_TIME_H
+
+#include "BigInt.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Arithmetic for secret values. A ConstantTimeInt is an unsigned integer of a
+// fixed number of 64-bit limbs that is never trimmed, and every operation
+// below runs the same instruction sequence and touches the same memory for
+// all operands of a given width: no early exits, no data-dependent branches
+// or indices, with conditions passed and returned as 0/1 words. Only widths,
+// moduli and exponent lengths may leak. Conversions from and to BigInt are
+// timed by limb counts alone once the value is in range. Storage is wiped on
+// destruction.
+class ConstantTimeInt {
+public:
+    // Constructors
+    explicit ConstantTimeInt(size_t limbCount);
+    // Throws InvalidInputException if value is negative or needs more than
+    // limbCount limbs.
+    ConstantTimeInt(const BigInt& value, size_t limbCount);
+    ConstantTimeInt(const ConstantTimeInt& other) = default;
+    ConstantTimeInt& operator=(const ConstantTimeInt& other);
+    ~ConstantTimeInt();
+
+    BigInt toBigInt() const;
+    size_t limbCount() const { return limbs.size(); }
+    uint64_t limb(size_t i) const { return limbs[i]; }
+
+    // this += other and this -= other modulo 2^(64 * limbCount()), returning
+    // the carry or borrow. Both operands must have the same width, as for
+    // every operation taking two ConstantTimeInts.
+    uint64_t add(const ConstantTimeInt& other);
+    uint64_t subtract(const ConstantTimeInt& other);
+
+    // -1, 0 or 1 as a is below, equal to or above b.
+    static int compare(const ConstantTimeInt& a, const ConstantTimeInt& b);
+    // 1 if a < b, else 0.
+    static uint64_t less(const ConstantTimeInt& a, const ConstantTimeInt& b);
+    // condition ? a : b, and a swap of a and b when condition is 1.
+    static ConstantTimeInt select(uint64_t condition, const ConstantTimeInt& a,
+                                  const ConstantTimeInt& b);
+    static void conditionalSwap(uint64_t condition, ConstantTimeInt& a, ConstantTimeInt& b);
+
+private:
+    friend class ConstantTimeModContext;
+
+    std::vector<uint64_t> limbs;
+};
+
+// Montgomery arithmetic modulo a public odd modulus in fixed-width form.
+// Operands must already be reduced below the modulus.
+class ConstantTimeModContext {
+public:
+    // Throws InvalidInputException unless modulus is odd and greater than 1.
+    explicit ConstantTimeModContext(const BigInt& modulus);
+
+    size_t limbCount() const { return modulus.limbCount(); }
+
+    // a * b mod m.
+    ConstantTimeInt multiply(const ConstantTimeInt& a, const ConstantTimeInt& b) const;
+
+    // base^exponent mod m by a Montgomery ladder over every bit of the
+    // exponent's width: one multiplication and one squaring per bit, with
+    // the ladder state exchanged by conditional swaps.
+    ConstantTimeInt modPow(const ConstantTimeInt& base, const ConstantTimeInt& exponent) const;
+
+    // Convenience wrapper for non-negative base and exponent. The base is
+    // reduced modulo m without branching on its value, so only its limb
+    // count shows, and the exponent is padded to at least the modulus width
+    // so that its length only shows through that width. Throws
+    // InvalidInputException for negative arguments.
+    BigInt modPow(const BigInt& base, const BigInt& exponent) const;
+
+private:
+    // r = a * b / R mod m with R = 2^(64n); r may alias a or b. scratch
+    // holds scratchLimbs(n) limbs, reused across calls and left holding
+    // intermediates, so callers keep it in a ConstantTimeInt to be wiped.
+    static size_t scratchLimbs(size_t n) { return 2 * n + 2; }
+    void montgomeryMultiply(uint64_t* r, const uint64_t* a, const uint64_t* b,
+                            uint64_t* scratch) const;
+    void addModulo(ConstantTimeInt& a, const ConstantTimeInt& b) const;
+    // value mod m for any non-negative value, in fixed-width form.
+    ConstantTimeInt reduce(const BigInt& value) const;
+
+    ConstantTimeInt modulus;
+    ConstantTimeInt one;        // R mod m
+    ConstantTimeInt rSquared;   // R^2 mod m
+    uint64_t inverse;           // -m^-1 mod 2^64
+};
+
+#endif // CONSTANT_TIME_H
@@ -0,0 +1,432 @@
+#include "LimbKernels.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LIMB_KERNELS_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+
+typedef uint64_t Limb;
+
+// Portable kernels
+inline Limb addCarry(Limb a, Limb b, Limb& carry) {
+    Limb sum = a + carry;
+    Limb overflow = sum < carry;
+    sum += b;
+    carry = overflow + (sum < b);
+    return sum;
+}
+
+inline Limb subBorrow(Limb a, Limb b, Limb& borrow) {
+    Limb diff = a - b;
+    Limb underflow = a < b;
+    underflow += diff < borrow;
+    diff -= borrow;
+    borrow = underflow;
+    return diff;
+}
+
+inline Limb mulAddCarry(Limb a, Limb b, Limb addend, Limb& carry) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 t = static_cast<unsigned __int128>(a) * b + addend + carry;
+    carry = static_cast<Limb>(t >> 64);
+    return static_cast<Limb>(t);
+#else
+    Limb a0 = a & 0xFFFFFFFFULL, a1 = a >> 32;
+    Limb b0 = b & 0xFFFFFFFFULL, b1 = b >> 32;
+    Limb p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    Limb middle = (p00 >> 32) + (p01 & 0xFFFFFFFFULL) + (p10 & 0xFFFFFFFFULL);
+    Limb low = (p00 & 0xFFFFFFFFULL) | (middle << 32);
+    Limb high = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+    Limb c = 0;
+    low = addCarry(low, addend, c);
+    high += c;
+    c = 0;
+    low = addCarry(low, carry, c);
+    carry = high + c;
+    return low;
+#endif
+}
+
+Limb addPortable(Limb* r, const Limb* a, const Limb* b, size_t n) {
+    Limb carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        r[i] = addCarry(a[i], b[i], carry);
+    }
+    return carry;
+}
+
+Limb subtractPortable(Limb* r, const Limb* a, const Limb* b, size_t n) {
+    Limb borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        r[i] = subBorrow(a[i], b[i], borrow);
+    }
+    return borrow;
+}
+
+Limb addMultiplePortable(Limb* r, const Limb* a, size_t n, Limb m) {
+    Limb carry = 0;
+    for (size_t j = 0; j < n; ++j) {
+        r[j] = mulAddCarry(a[j], m, r[j], carry);
+    }
+    return carry;
+}
+
+void multiplyPortable(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    std::fill(r, r + an + bn, 0);
+    for (size_t i = 0; i < an; ++i) {
+        r[i + bn] = addMultiplePortable(r + i, b, bn, a[i]);
+    }
+}
+
+const LimbKernels PORTABLE = {"portable", 32, addPortable, subtractPortable, addMultiplePortable,
+                              multiplyPortable};
+
+#ifdef LIMB_KERNELS_X86
+
+// ADX kernels. Loop counters move with lea and jrcxz, which leave the flags
+// alone, so the carry chains run unbroken across iterations; dec would do
+// for adc alone but clobbers the overflow flag that adox carries.
+Limb addAdx(Limb* r, const Limb* a, const Limb* b, size_t n) {
+    size_t rest = n % 4, blocks = n / 4;
+    unsigned char carry;
+    __asm__ volatile(
+        "mov %[rest], %%rcx\n\t"
+        "clc\n\t"
+        "jrcxz 2f\n"
+        "1:\n\t"
+        "mov (%[a]), %%r8\n\t"
+        "adc (%[b]), %%r8\n\t"
+        "mov %%r8, (%[r])\n\t"
+        "lea 8(%[a]), %[a]\n\t"
+        "lea 8(%[b]), %[b]\n\t"
+        "lea 8(%[r]), %[r]\n\t"
+        "lea -1(%%rcx), %%rcx\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n"
+        "2:\n\t"
+        "mov %[blocks], %%rcx\n\t"
+        "jrcxz 4f\n"
+        "3:\n\t"
+        "mov (%[a]), %%r8\n\t"
+        "mov 8(%[a]), %%r9\n\t"
+        "mov 16(%[a]), %%r10\n\t"
+        "mov 24(%[a]), %%r11\n\t"
+        "adc (%[b]), %%r8\n\t"
+        "adc 8(%[b]), %%r9\n\t"
+        "adc 16(%[b]), %%r10\n\t"
+        "adc 24(%[b]), %%r11\n\t"
+        "mov %%r8, (%[r])\n\t"
+        "mov %%r9, 8(%[r])\n\t"
+        "mov %%r10, 16(%[r])\n\t"
+        "mov %%r11, 24(%[r])\n\t"
+        "lea 32(%[a]), %[a]\n\t"
+        "lea 32(%[b]), %[b]\n\t"
+        "lea 32(%[r]), %[r]\n\t"
+        "lea -1(%%rcx), %%rcx\n\t"
+        "jrcxz 4f\n\t"
+        "jmp 3b\n"
+        "4:\n\t"
+        "setc %[carry]\n\t"
+        : [r] "+r"(r), [a] "+r"(a), [b] "+r"(b), [carry] "=q"(carry)
+        : [rest] "r"(rest), [blocks] "r"(blocks)
+        : "rcx", "r8", "r9", "r10", "r11", "cc", "memory");
+    return carry;
+}
+
+Limb subtractAdx(Limb* r, const Limb* a, const Limb* b, size_t n) {
+    size_t rest = n % 4, blocks = n / 4;
+    unsigned char borrow;
+    __asm__ volatile(
+        "mov %[rest], %%rcx\n\t"
+        "clc\n\t"
+        "jrcxz 2f\n"
+        "1:\n\t"
+        "mov (%[a]), %%r8\n\t"
+        "sbb (%[b]), %%r8\n\t"
+        "mov %%r8, (%[r])\n\t"
+        "lea 8(%[a]), %[a]\n\t"
+        "lea 8(%[b]), %[b]\n\t"
+        "lea 8(%[r]), %[r]\n\t"
+        "lea -1(%%rcx), %%rcx\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n"
+        "2:\n\t"
+        "mov %[blocks], %%rcx\n\t"
+        "jrcxz 4f\n"
+        "3:\n\t"
+        "mov (%[a]), %%r8\n\t"
+        "mov 8(%[a]), %%r9\n\t"
+        "mov 16(%[a]), %%r10\n\t"
+        "mov 24(%[a]), %%r11\n\t"
+        "sbb (%[b]), %%r8\n\t"
+        "sbb 8(%[b]), %%r9\n\t"
+        "sbb 16(%[b]), %%r10\n\t"
+        "sbb 24(%[b]), %%r11\n\t"
+        "mov %%r8, (%[r])\n\t"
+        "mov %%r9, 8(%[r])\n\t"
+        "mov %%r10, 16(%[r])\n\t"
+        "mov %%r11, 24(%[r])\n\t"
+        "lea 32(%[a]), %[a]\n\t"
+        "lea 32(%[b]), %[b]\n\t"
+        "lea 32(%[r]), %[r]\n\t"
+        "lea -1(%%rcx), %%rcx\n\t"
+        "jrcxz 4f\n\t"
+        "jmp 3b\n"
+        "4:\n\t"
+        "setc %[borrow]\n\t"
+        : [r] "+r"(r), [a] "+r"(a), [b] "+r"(b), [borrow] "=q"(borrow)
+        : [rest] "r"(rest), [blocks] "r"(blocks)
+        : "rcx", "r8", "r9", "r10", "r11", "cc", "memory");
+    return borrow;
+}
+
+// Each limb adds the low half of a[i] * m (mulx, flags untouched) to the
+// previous high half on the overflow chain and to r[i] on the carry chain.
+// The two final flags and the last high half make up the carry limb.
+Limb addMultipleAdx(Limb* r, const Limb* a, size_t n, Limb m) {
+    size_t rest = n % 4, blocks = n / 4;
+    Limb carry;
+    __asm__ volatile(
+        "xor %k[carry], %k[carry]\n\t"
+        "mov %[rest], %%rcx\n\t"
+        "jrcxz 2f\n"
+        "1:\n\t"
+        "mulx (%[a]), %%r8, %%r9\n\t"
+        "adox %[carry], %%r8\n\t"
+        "adcx (%[r]), %%r8\n\t"
+        "mov %%r8, (%[r])\n\t"
+        "mov %%r9, %[carry]\n\t"
+        "lea 8(%[a]), %[a]\n\t"
+        "lea 8(%[r]), %[r]\n\t"
+        "lea -1(%%rcx), %%rcx\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n"
+        "2:\n\t"
+        "mov %[blocks], %%rcx\n\t"
+        "jrcxz 4f\n"
+        "3:\n\t"
+        "mulx (%[a]), %%r8, %%r9\n\t"
+        "adox %[carry], %%r8\n\t"
+        "adcx (%[r]), %%r8\n\t"
+        "mov %%r8, (%[r])\n\t"
+        "mulx 8(%[a]), %%r8, %[carry]\n\t"
+        "adox %%r9, %%r8\n\t"
+        "adcx 8(%[r]), %%r8\n\t"
+        "mov %%r8, 8(%[r])\n\t"
+        "mulx 16(%[a]), %%r8, %%r9\n\t"
+        "adox %[carry], %%r8\n\t"
+        "adcx 16(%[r]), %%r8\n\t"
+        "mov %%r8, 16(%[r])\n\t"
+        "mulx 24(%[a]), %%r8, %[carry]\n\t"
+        "adox %%r9, %%r8\n\t"
+        "adcx 24(%[r]), %%r8\n\t"
+        "mov %%r8, 24(%[r])\n\t"
+        "lea 32(%[a]), %[a]\n\t"
+        "lea 32(%[r]), %[r]\n\t"
+        "lea -1(%%rcx), %%rcx\n\t"
+        "jrcxz 4f\n\t"
+        "jmp 3b\n"
+        "4:\n\t"
+        "mov $0, %%r8d\n\t"
+        "adox %%r8, %[carry]\n\t"
+        "adcx %%r8, %[carry]\n\t"
+        : [r] "+r"(r), [a] "+r"(a), [carry] "=&r"(carry)
+        : [rest] "r"(rest), [blocks] "r"(blocks), "d"(m)
+        : "rcx", "r8", "r9", "cc", "memory");
+    return carry;
+}
+
+void multiplyAdx(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    std::fill(r, r + an + bn, 0);
+    // Rows along the longer operand keep the unrolled loop busy.
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    for (size_t i = 0; i < bn; ++i) {
+        r[i + an] = addMultipleAdx(r + i, a, an, b[i]);
+    }
+}
+
+// AVX-512 IFMA basecase. Both operands are cut into 52-bit digits, and each
+// group of eight product columns is summed in registers: vpmadd52luq adds
+// the low 52 bits of digit products a[c - j] * b[j] and vpmadd52huq the high
+// bits of a[c - 1 - j] * b[j], lane t holding column c + t. A column takes
+// at most 2 * min(da, db) terms below 2^52, far from overflowing 64 bits at
+// these sizes. One carry pass then repacks the columns into limbs.
+// Below IFMA_MIN_LIMBS the digit conversion costs more than the vector
+// products save, and the ADX rows are faster.
+const size_t IFMA_MIN_LIMBS = 24;
+const size_t IFMA_MAX_LIMBS = 128;
+const size_t IFMA_MAX_DIGITS = (64 * IFMA_MAX_LIMBS + 51) / 52;
+const Limb DIGIT_MASK = (Limb(1) << 52) - 1;
+
+void toDigits(Limb* d, size_t dn, const Limb* x, size_t n) {
+    for (size_t k = 0; k < dn; ++k) {
+        size_t bit = 52 * k;
+        size_t i = bit / 64;
+        unsigned offset = static_cast<unsigned>(bit % 64);
+        Limb v = x[i] >> offset;
+        if (offset > 12 && i + 1 < n) {
+            v |= x[i + 1] << (64 - offset);
+        }
+        d[k] = v & DIGIT_MASK;
+    }
+}
+
+__attribute__((target("avx512f,avx512ifma")))
+void multiplyIfma(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    if (std::min(an, bn) < IFMA_MIN_LIMBS || an > IFMA_MAX_LIMBS || bn > IFMA_MAX_LIMBS) {
+        multiplyAdx(r, a, an, b, bn);
+        return;
+    }
+    size_t da = (64 * an + 51) / 52;
+    size_t db = (64 * bn + 51) / 52;
+    size_t columns = da + db;
+
+    // a's digits sit between eight zero digits below and sixteen above, so
+    // every window the loop loads is in bounds: digit b[j] meets a's digits
+    // in this block's columns for j from c - (da - 1) - 1 to c + 7.
+    alignas(64) Limb paddedA[IFMA_MAX_DIGITS + 24];
+    alignas(64) Limb digitsB[IFMA_MAX_DIGITS];
+    alignas(64) Limb sums[2 * IFMA_MAX_DIGITS + 8];
+    Limb* digitsA = paddedA + 8;
+    std::fill(paddedA, digitsA, 0);
+    std::fill(digitsA + da, digitsA + da + 16, 0);
+    toDigits(digitsA, da, a, an);
+    toDigits(digitsB, db, b, bn);
+
+    const long long lastA = static_cast<long long>(da) - 1;
+    const long long lastB = static_cast<long long>(db) - 1;
+    for (size_t base = 0; base < columns; base += 8) {
+        long long c = static_cast<long long>(base);
+        long long first = std::max(0LL, c - lastA - 1);
+        long long last = std::min(lastB, c + 7);
+        __m512i low0 = _mm512_setzero_si512(), high0 = _mm512_setzero_si512();
+        __m512i low1 = _mm512_setzero_si512(), high1 = _mm512_setzero_si512();
+        long long j = first;
+        for (; j + 1 <= last; j += 2) {
+            __m512i b0 = _mm512_set1_epi64(static_cast<long long>(digitsB[j]));
+            __m512i b1 = _mm512_set1_epi64(static_cast<long long>(digitsB[j + 1]));
+            low0 = _mm512_madd52lo_epu64(low0, _mm512_loadu_si512(digitsA + c - j), b0);
+            high0 = _mm512_madd52hi_epu64(high0, _mm512_loadu_si512(digitsA + c - j - 1), b0);
+            low1 = _mm512_madd52lo_epu64(low1, _mm512_loadu_si512(digitsA + c - j - 1), b1);
+            high1 = _mm512_madd52hi_epu64(high1, _mm512_loadu_si512(digitsA + c - j - 2), b1);
+        }
+        if (j <= last) {
+            __m512i b0 = _mm512_set1_epi64(static_cast<long long>(digitsB[j]));
+            low0 = _mm512_madd52lo_epu64(low0, _mm512_loadu_si512(digitsA + c - j), b0);
+            high0 = _mm512_madd52hi_epu64(high0, _mm512_loadu_si512(digitsA + c - j - 1), b0);
+        }
+        __m512i total = _mm512_add_epi64(_mm512_add_epi64(low0, high0), _mm512_add_epi64(low1, high1));
+        _mm512_store_si512(sums + base, total);
+    }
+
+    // Propagate column carries in radix 2^52 and stream the digits out as
+    // 64-bit limbs; the product fits an + bn limbs exactly.
+    unsigned __int128 pending = 0;
+    unsigned bits = 0;
+    Limb carry = 0;
+    size_t out = 0;
+    for (size_t k = 0; k < columns && out < an + bn; ++k) {
+        Limb t = sums[k] + carry;
+        carry = t >> 52;
+        pending |= static_cast<unsigned __int128>(t & DIGIT_MASK) << bits;
+        bits += 52;
+        if (bits >= 64) {
+            r[out++] = static_cast<Limb>(pending);
+            pending >>= 64;
+            bits -= 64;
+        }
+    }
+    if (out < an + bn) {
+        r[out++] = static_cast<Limb>(pending);
+    }
+    std::fill(r + out, r + an + bn, 0);
+}
+
+const LimbKernels ADX = {"adx", 64, addAdx, subtractAdx, addMultipleAdx, multiplyAdx};
+const LimbKernels IFMA = {"ifma", 64, addAdx, subtractAdx, addMultipleAdx, multiplyIfma};
+
+struct CpuFeatures {
+    bool adx = false;
+    bool ifma = false;
+};
+
+// BMI2 and ADX from CPUID leaf 7. IFMA also needs AVX-512F and the operating
+// system saving the opmask and ZMM state, which XCR0 reports.
+CpuFeatures detectFeatures() {
+    CpuFeatures features;
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return features;
+    }
+    bool osxsave = (ecx & (1u << 27)) != 0;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return features;
+    }
+    features.adx = (ebx & (1u << 8)) != 0 && (ebx & (1u << 19)) != 0;
+    bool avx512f = (ebx & (1u << 16)) != 0;
+    bool avx512ifma = (ebx & (1u << 21)) != 0;
+    if (features.adx && osxsave && avx512f && avx512ifma) {
+        unsigned low, high;
+        __asm__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+        features.ifma = (low & 0xE6) == 0xE6;
+    }
+    return features;
+}
+
+#endif // LIMB_KERNELS_X86
+
+// Kernels this CPU can run, best first.
+struct Candidates {
+    const LimbKernels* list[3];
+    size_t count = 0;
+};
+
+Candidates supportedKernels() {
+    Candidates candidates;
+#ifdef LIMB_KERNELS_X86
+    CpuFeatures features = detectFeatures();
+    if (features.ifma) {
+        candidates.list[candidates.count++] = &IFMA;
+    }
+    if (features.adx) {
+        candidates.list[candidates.count++] = &ADX;
+    }
+#endif
+    candidates.list[candidates.count++] = &PORTABLE;
+    return candidates;
+}
+
+const LimbKernels& selectKernels() {
+    if (const char* requested = std::getenv("BIGINT_KERNEL")) {
+        if (const LimbKernels* kernels = LimbKernels::find(requested)) {
+            return *kernels;
+        }
+    }
+    return *supportedKernels().list[0];
+}
+
+} // namespace
+
+const LimbKernels* LimbKernels::find(const char* name) {
+    Candidates candidates = supportedKernels();
+    for (size_t i = 0; i < candidates.count; ++i) {
+        if (std::strcmp(candidates.list[i]->name, name) == 0) {
+            return candidates.list[i];
+        }
+    }
+    return nullptr;
+}
+
+const LimbKernels& LimbKernels::active() {
+    static const LimbKernels& kernels = selectKernels();
+    return kernels;
+}
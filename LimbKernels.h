@@ -0,0 +1,41 @@
+#ifndef LIMB_KERNELS_H
+#define LIMB_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// The innermost limb loops, with variants for the host CPU chosen once per
+// process. BigInt routes its basecase addition, subtraction and
+// multiplication through the active set:
+//
+//   portable  plain C++ with 128-bit products where the compiler has them
+//   adx       x86-64 BMI2/ADX: mulx with two independent carry chains
+//             (adcx/adox) for multiply-accumulate, unrolled adc/sbb chains
+//   ifma      adx plus an AVX-512 IFMA basecase product in radix 2^52
+//
+// By default the fastest kernel the CPU supports is used. Setting the
+// BIGINT_KERNEL environment variable to one of the names above forces that
+// kernel instead, for A/B comparisons; a name the CPU cannot run is ignored
+// in favour of the default. All kernels give identical results.
+struct LimbKernels {
+    const char* name;
+    // Operand size in limbs from which Karatsuba beats this basecase; the
+    // default BigInt::MultiplyThresholds::karatsuba follows it.
+    size_t karatsubaThreshold;
+    // r[0..n) = a[0..n) + b[0..n) and a - b, returning the carry or borrow
+    // out. r may be the same array as a or b.
+    uint64_t (*add)(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n);
+    uint64_t (*subtract)(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n);
+    // r[0..n) += a[0..n) * m, returning the carry limb.
+    uint64_t (*addMultiple)(uint64_t* r, const uint64_t* a, size_t n, uint64_t m);
+    // r[0..an+bn) = a * b by the quadratic basecase, for an, bn >= 1; r must
+    // not overlap either operand.
+    void (*multiply)(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn);
+
+    // The kernels in use, selected on first call.
+    static const LimbKernels& active();
+    // The kernel of that name if this CPU can run it, else null.
+    static const LimbKernels* find(const char* name);
+};
+
+#endif // LIMB_KERNELS_H
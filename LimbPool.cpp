@@ -0,0 +1,105 @@
+#include "LimbPool.h"
+#include <algorithm>
+
+namespace {
+
+// Index of the smallest power of two >= bytes.
+size_t sizeClass(size_t bytes) {
+    size_t index = 0;
+    while ((size_t(1) << index) < bytes) {
+        ++index;
+    }
+    return index;
+}
+
+} // namespace
+
+LimbPool::LimbPool(std::pmr::memory_resource* upstream)
+    : upstream(upstream), cursor(nullptr), limit(nullptr),
+      nextChunkBytes(FIRST_CHUNK_BYTES), chunks(nullptr), largeBlocks(nullptr) {
+    std::fill(freeLists, freeLists + LARGEST_CLASS + 1, nullptr);
+}
+
+LimbPool::~LimbPool() {
+    release();
+}
+
+void LimbPool::release() {
+    freeList(chunks);
+    freeList(largeBlocks);
+    std::fill(freeLists, freeLists + LARGEST_CLASS + 1, nullptr);
+    cursor = limit = nullptr;
+    nextChunkBytes = FIRST_CHUNK_BYTES;
+}
+
+void* LimbPool::do_allocate(size_t bytes, size_t alignment) {
+    if (bytes > LARGEST_POOLED || alignment > alignof(std::max_align_t)) {
+        return allocateFromUpstream(bytes, largeBlocks);
+    }
+
+    size_t index = std::max(sizeClass(bytes), SMALLEST_CLASS);
+    if (FreeBlock* block = freeLists[index]) {
+        freeLists[index] = block->next;
+        return block;
+    }
+
+    // Blocks are powers of two of at least 16 bytes carved from the start of
+    // an aligned chunk, so the cursor stays 16-byte aligned.
+    size_t blockBytes = size_t(1) << index;
+    if (static_cast<size_t>(limit - cursor) < blockBytes) {
+        size_t chunkBytes = std::max(nextChunkBytes, blockBytes);
+        cursor = static_cast<char*>(allocateFromUpstream(chunkBytes, chunks));
+        limit = cursor + chunkBytes;
+        nextChunkBytes = std::min(2 * nextChunkBytes, LARGEST_CHUNK_BYTES);
+    }
+    void* block = cursor;
+    cursor += blockBytes;
+    return block;
+}
+
+void LimbPool::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    if (bytes > LARGEST_POOLED || alignment > alignof(std::max_align_t)) {
+        freeToUpstream(static_cast<Header*>(p) - 1, largeBlocks);
+        return;
+    }
+
+    size_t index = std::max(sizeClass(bytes), SMALLEST_CLASS);
+    FreeBlock* block = static_cast<FreeBlock*>(p);
+    block->next = freeLists[index];
+    freeLists[index] = block;
+}
+
+bool LimbPool::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+void* LimbPool::allocateFromUpstream(size_t bytes, Header*& list) {
+    void* raw = upstream->allocate(sizeof(Header) + bytes, alignof(Header));
+    Header* header = static_cast<Header*>(raw);
+    header->previous = nullptr;
+    header->next = list;
+    header->bytes = bytes;
+    if (list) {
+        list->previous = header;
+    }
+    list = header;
+    return header + 1;
+}
+
+void LimbPool::freeToUpstream(Header* header, Header*& list) {
+    if (header->previous) {
+        header->previous->next = header->next;
+    } else {
+        list = header->next;
+    }
+    if (header->next) {
+        header->next->previous = header->previous;
+    }
+    upstream->deallocate(header, sizeof(Header) + header->bytes, alignof(Header));
+}
+
+void LimbPool::freeList(Header*& list) {
+    while (list) {
+        freeToUpstream(list, list);
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef LIMB_POOL_H
+#define LIMB_POOL_H
+
+#include <cstddef>
+#include <memory_resource>
+
+// Single-threaded size-class pool for limb buffers. Requests are rounded up
+// to a power of two and served from per-class free lists, refilled by bump
+// allocation from chunks taken from the upstream resource; requests above
+// LARGEST_POOLED bytes go to upstream directly. Freed blocks return to their
+// free list, and release() (or the destructor) hands every chunk and large
+// block back to upstream at once.
+class LimbPool : public std::pmr::memory_resource {
+public:
+    static constexpr size_t LARGEST_POOLED = size_t(1) << 20;
+
+    explicit LimbPool(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    ~LimbPool() override;
+
+    LimbPool(const LimbPool&) = delete;
+    LimbPool& operator=(const LimbPool&) = delete;
+
+    // Frees all memory obtained from upstream, invalidating every block
+    // handed out so far.
+    void release();
+
+private:
+    static constexpr size_t SMALLEST_CLASS = 4;    // 16-byte blocks
+    static constexpr size_t LARGEST_CLASS = 20;
+    static constexpr size_t FIRST_CHUNK_BYTES = size_t(64) << 10;
+    static constexpr size_t LARGEST_CHUNK_BYTES = size_t(16) << 20;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // Prefix of every chunk and large block, linking it for release().
+    struct alignas(std::max_align_t) Header {
+        Header* previous;
+        Header* next;
+        size_t bytes;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    void* allocateFromUpstream(size_t bytes, Header*& list);
+    void freeToUpstream(Header* header, Header*& list);
+    void freeList(Header*& list);
+
+    std::pmr::memory_resource* upstream;
+    FreeBlock* freeLists[LARGEST_CLASS + 1];
+    char* cursor;
+    char* limit;
+    size_t nextChunkBytes;
+    Header* chunks;
+    Header* largeBlocks;
+};
+
+#endif // LIMB_POOL_H
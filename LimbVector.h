@@ -0,0 +1,242 @@
+#ifndef LIMB_VECTOR_H
+#define LIMB_VECTOR_H
+
+#include "BigIntStats.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+
+// Contiguous limb buffer with the subset of the std::vector interface BigInt
+// uses. Up to INLINE_CAPACITY limbs (128 bits) are stored inside the object
+// itself; the buffer moves to the heap only when it grows past that, and
+// keeps its heap capacity afterwards like a vector would.
+//
+// Heap storage comes from the memory resource captured at construction: the
+// calling thread's currentResource(), or global operator new when that is
+// null. As with std::pmr containers, copies and moves between buffers on
+// different resources copy the limbs rather than hand over the allocation.
+class LimbVector {
+public:
+    typedef uint64_t value_type;
+    typedef uint64_t* iterator;
+    typedef const uint64_t* const_iterator;
+
+    static constexpr size_t INLINE_CAPACITY = 2;
+
+    // Resource new buffers on this thread allocate from; null means global
+    // operator new.
+    static std::pmr::memory_resource*& currentResource() {
+        static thread_local std::pmr::memory_resource* resource = nullptr;
+        return resource;
+    }
+
+    // Constructors
+    LimbVector() : count(0), allocated(INLINE_CAPACITY), resource(currentResource()) {}
+
+    explicit LimbVector(std::pmr::memory_resource* resource)
+        : count(0), allocated(INLINE_CAPACITY), resource(resource) {}
+
+    explicit LimbVector(size_t n, uint64_t value = 0)
+        : count(0), allocated(INLINE_CAPACITY), resource(currentResource()) {
+        assign(n, value);
+    }
+
+    LimbVector(const uint64_t* first, const uint64_t* last)
+        : count(0), allocated(INLINE_CAPACITY), resource(currentResource()) {
+        assign(first, last);
+    }
+
+    LimbVector(const LimbVector& other)
+        : count(0), allocated(INLINE_CAPACITY), resource(currentResource()) {
+        assign(other.begin(), other.end());
+    }
+
+    LimbVector(LimbVector&& other) noexcept
+        : count(0), allocated(INLINE_CAPACITY), resource(other.resource) {
+        take(other);
+    }
+
+    ~LimbVector() {
+        release();
+    }
+
+    // Assignment operators
+    LimbVector& operator=(const LimbVector& other) {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    // Not noexcept: a move from a buffer on another resource copies.
+    LimbVector& operator=(LimbVector&& other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (resource == other.resource || other.isInline()) {
+            release();
+            take(other);
+        } else {
+            assign(other.begin(), other.end());
+            other.count = 0;
+        }
+        return *this;
+    }
+
+    // Element access
+    uint64_t* data() { return isInline() ? inlineLimbs : heap; }
+    const uint64_t* data() const { return isInline() ? inlineLimbs : heap; }
+    uint64_t& operator[](size_t i) { return data()[i]; }
+    const uint64_t& operator[](size_t i) const { return data()[i]; }
+    uint64_t& back() { return data()[count - 1]; }
+    const uint64_t& back() const { return data()[count - 1]; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + count; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + count; }
+
+    // Capacity
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return allocated; }
+    bool isInline() const { return allocated == INLINE_CAPACITY; }
+
+    void reserve(size_t n) {
+        if (n > allocated) {
+            reallocate(n);
+        }
+    }
+
+    // Modifiers
+    void clear() { count = 0; }
+
+    // New limbs take the given value, zero by default.
+    void resize(size_t n, uint64_t value = 0) {
+        if (n > allocated) {
+            reallocate(std::max(n, 2 * allocated));
+        }
+        if (n > count) {
+            std::fill(data() + count, data() + n, value);
+        }
+        count = n;
+    }
+
+    void push_back(uint64_t value) {
+        if (count == allocated) {
+            reallocate(2 * allocated);
+        }
+        data()[count++] = value;
+    }
+
+    void pop_back() { --count; }
+
+    void assign(size_t n, uint64_t value) {
+        count = 0;
+        resize(n, value);
+    }
+
+    // The range may not point into this buffer.
+    void assign(const uint64_t* first, const uint64_t* last) {
+        size_t n = static_cast<size_t>(last - first);
+        count = 0;
+        reserve(n);
+        if (n) {
+            std::memcpy(data(), first, n * sizeof(uint64_t));
+        }
+        count = n;
+    }
+
+    // Inserts [first, last) before position. The range may not point into
+    // this buffer.
+    void insert(const_iterator position, const uint64_t* first, const uint64_t* last) {
+        size_t offset = static_cast<size_t>(position - begin());
+        size_t n = static_cast<size_t>(last - first);
+        if (n == 0) {
+            return;
+        }
+        if (count + n > allocated) {
+            reallocate(std::max(count + n, 2 * allocated));
+        }
+        uint64_t* p = data();
+        std::memmove(p + offset + n, p + offset, (count - offset) * sizeof(uint64_t));
+        std::memcpy(p + offset, first, n * sizeof(uint64_t));
+        count += n;
+    }
+
+    void swap(LimbVector& other) {
+        if (resource == other.resource) {
+            LimbVector temp(static_cast<LimbVector&&>(other));
+            other = static_cast<LimbVector&&>(*this);
+            *this = static_cast<LimbVector&&>(temp);
+        } else {
+            LimbVector temp(other.resource);
+            temp = other;
+            other = *this;
+            *this = temp;
+        }
+    }
+
+    std::pmr::memory_resource* memoryResource() const { return resource; }
+
+    bool operator==(const LimbVector& other) const {
+        return count == other.count && std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const LimbVector& other) const { return !(*this == other); }
+
+private:
+    // Moves the contents to a buffer of the given capacity, >= size().
+    void reallocate(size_t capacity) {
+        size_t bytes = capacity * sizeof(uint64_t);
+        BIGINT_STATS_ALLOCATION(bytes);
+        void* block = resource ? resource->allocate(bytes, alignof(uint64_t)) : ::operator new(bytes);
+        uint64_t* buffer = static_cast<uint64_t*>(block);
+        if (count) {
+            std::memcpy(buffer, data(), count * sizeof(uint64_t));
+        }
+        release();
+        heap = buffer;
+        allocated = capacity;
+    }
+
+    // Frees heap storage and returns to the inline buffer, keeping count.
+    void release() {
+        if (!isInline()) {
+            if (resource) {
+                resource->deallocate(heap, allocated * sizeof(uint64_t), alignof(uint64_t));
+            } else {
+                ::operator delete(heap);
+            }
+            allocated = INLINE_CAPACITY;
+        }
+    }
+
+    // Takes other's contents, leaving it empty and inline. *this must hold no
+    // heap storage, and takes over other's resource along with its buffer.
+    void take(LimbVector& other) {
+        count = other.count;
+        if (other.isInline()) {
+            std::memcpy(inlineLimbs, other.inlineLimbs, sizeof(inlineLimbs));
+        } else {
+            heap = other.heap;
+            allocated = other.allocated;
+            resource = other.resource;
+            other.allocated = INLINE_CAPACITY;
+        }
+        other.count = 0;
+    }
+
+    size_t count;
+    size_t allocated;
+    std::pmr::memory_resource* resource;
+    union {
+        uint64_t inlineLimbs[INLINE_CAPACITY];
+        uint64_t* heap;
+    };
+};
+
+#endif // LIMB_VECTOR_H
@@ -0,0 +1,129 @@
+#include "ThreadPool.h"
+#include <atomic>
+#include <exception>
+
+struct ThreadPool::TaskGroup::Task {
+    enum State { PENDING, RUNNING, DONE };
+
+    explicit Task(std::function<void()> work) : work(std::move(work)) {}
+
+    std::function<void()> work;
+    std::atomic<int> state{PENDING};
+    std::exception_ptr error;
+};
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::~ThreadPool() {
+    resize(0);
+}
+
+void ThreadPool::resize(unsigned count) {
+    std::vector<std::thread> previous;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        previous.swap(workers);
+    }
+    queued.notify_all();
+    for (std::thread& worker : previous) {
+        worker.join();
+    }
+
+    // Entries left in the queue were claimed by their groups' wait().
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = false;
+    queue.clear();
+    workers.reserve(count);
+    for (unsigned i = 0; i < count; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+unsigned ThreadPool::workerCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<unsigned>(workers.size());
+}
+
+void ThreadPool::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        queued.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (stopping) {
+            return;
+        }
+        std::shared_ptr<TaskGroup::Task> task = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+        TaskGroup::runIfPending(*this, *task);
+        task.reset();
+        lock.lock();
+    }
+}
+
+ThreadPool::TaskGroup::TaskGroup(bool parallel, ThreadPool& pool)
+    : pool(pool), parallel(parallel && pool.workerCount() > 0) {}
+
+ThreadPool::TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void ThreadPool::TaskGroup::submit(std::function<void()> work) {
+    std::shared_ptr<Task> task = std::make_shared<Task>(std::move(work));
+    tasks.push_back(task);
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.queue.push_back(std::move(task));
+    }
+    pool.queued.notify_one();
+}
+
+void ThreadPool::TaskGroup::runIfPending(ThreadPool& pool, Task& task) {
+    int expected = Task::PENDING;
+    if (!task.state.compare_exchange_strong(expected, Task::RUNNING)) {
+        return;
+    }
+    try {
+        task.work();
+    } catch (...) {
+        task.error = std::current_exception();
+    }
+    task.work = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        task.state = Task::DONE;
+    }
+    pool.finished.notify_all();
+}
+
+void ThreadPool::TaskGroup::wait() {
+    if (tasks.empty()) {
+        return;
+    }
+
+    // The newest tasks are the least likely to have been picked up.
+    for (size_t i = tasks.size(); i-- > 0;) {
+        runIfPending(pool, *tasks[i]);
+    }
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(pool.mutex);
+        for (const std::shared_ptr<Task>& task : tasks) {
+            pool.finished.wait(lock, [&task] { return task->state == Task::DONE; });
+            if (!error) {
+                error = task->error;
+            }
+        }
+    }
+    tasks.clear();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Process-wide set of worker threads for fork-join parallelism inside
+// BigInt's divide-and-conquer kernels. Work is submitted through a
+// TaskGroup; a group's wait() runs every task no worker has started yet on
+// the calling thread before blocking on the rest, so groups nested inside
+// tasks never deadlock, whatever the number of workers.
+//
+// Workers allocate limb buffers from the global heap: a memory resource
+// installed on the submitting thread does not apply to them.
+class ThreadPool {
+public:
+    // The pool BigInt uses; it has no workers until resize() is called.
+    static ThreadPool& shared();
+
+    ThreadPool() = default;
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Joins the current workers and starts `workers` new ones. Must not be
+    // called while any group on this pool is running tasks.
+    void resize(unsigned workers);
+    unsigned workerCount() const;
+
+    // Tasks forked together and joined by wait(). Without workers, or when
+    // constructed with parallel = false, run() executes each task at once.
+    class TaskGroup {
+    public:
+        explicit TaskGroup(bool parallel = true, ThreadPool& pool = ThreadPool::shared());
+        // Waits for outstanding tasks, discarding their exceptions.
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        template <typename Work>
+        void run(Work&& work) {
+            if (!parallel) {
+                work();
+                return;
+            }
+            submit(std::function<void()>(std::forward<Work>(work)));
+        }
+
+        // Returns once every task has finished, rethrowing the first
+        // exception one of them threw.
+        void wait();
+
+        // Whether run() hands tasks to the pool.
+        bool runsInParallel() const { return parallel; }
+
+    private:
+        friend class ThreadPool;
+        struct Task;
+
+        void submit(std::function<void()> work);
+        // Runs task unless another thread already claimed it.
+        static void runIfPending(ThreadPool& pool, Task& task);
+
+        ThreadPool& pool;
+        bool parallel;
+        std::vector<std::shared_ptr<Task>> tasks;
+    };
+
+private:
+    void workerLoop();
+
+    mutable std::mutex mutex;
+    std::condition_variable queued;
+    std::condition_variable finished;
+    std::deque<std::shared_ptr<TaskGroup::Task>> queue;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,362 @@
+// Google Benchmark suite for the core operations, swept from one limb up to
+// about 10^7 decimal digits (2^19 limbs) where the algorithm allows it.
+// When built with BIGINT_BENCHMARK_GMP (CMake defines it if GMP is found),
+// every case is also timed on GMP with the same operands, registered right
+// after its BigInt twin: Multiply/BigInt/4096 is followed by
+// Multiply/GMP/4096. Sizes are in limbs, except decimal digits for ToString
+// and Parse.
+//
+// Run:  ./bigint_benchmarks --benchmark_out=results.json --benchmark_out_format=json
+//       ./bigint_benchmarks --benchmark_filter=Multiply --bigint_threads=8
+// --bigint_threads sets BigInt::ParallelPolicy::threads (0 for every core).
+// Two JSON files, or the two libraries within one run, can be compared with
+// Google Benchmark's tools/compare.py:
+//       compare.py benchmarks before.json after.json
+//       compare.py filters ./bigint_benchmarks Multiply/BigInt Multiply/GMP
+
+#include "BigInt.h"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef BIGINT_BENCHMARK_GMP
+#include <gmp.h>
+#endif
+
+namespace {
+
+// About 10^7 decimal digits.
+const size_t MAX_LIMBS = size_t(1) << 19;
+const size_t MAX_DIGITS = 10000000;
+// Lehmer's GCD is quadratic, and finding large primes to test dominates
+// the run, so these stop lower.
+const size_t MAX_GCD_LIMBS = 4096;
+const size_t MAX_PRIME_LIMBS = 32;
+
+// Powers of eight up to limit, then limit itself.
+std::vector<size_t> limbSizes(size_t limit) {
+    std::vector<size_t> sizes;
+    for (size_t n = 1; n < limit; n *= 8) {
+        sizes.push_back(n);
+    }
+    sizes.push_back(limit);
+    return sizes;
+}
+
+// Hex digits of a random number of exactly `limbs` limbs, the same for
+// every library and every run.
+std::string randomHex(size_t limbs, uint64_t seed) {
+    static const char HEX[] = "0123456789abcdef";
+    std::mt19937_64 rng(seed * 0x9E3779B97F4A7C15ULL + limbs);
+    std::string hex(16 * limbs, '0');
+    for (char& c : hex) {
+        c = HEX[rng() & 15];
+    }
+    hex[0] = HEX[8 + (rng() & 7)];
+    return hex;
+}
+
+// Random decimal digits without a leading zero.
+std::string randomDecimal(size_t digits, uint64_t seed) {
+    std::mt19937_64 rng(seed + digits);
+    std::string decimal(digits, '0');
+    for (char& c : decimal) {
+        c = static_cast<char>('0' + rng() % 10);
+    }
+    decimal[0] = static_cast<char>('1' + rng() % 9);
+    return decimal;
+}
+
+// Odd operands: the modulus for modPow and the GCD inputs.
+std::string oddHex(size_t limbs, uint64_t seed) {
+    std::string hex = randomHex(limbs, seed);
+    hex.back() = '1';
+    return hex;
+}
+
+// A prime of `limbs` limbs in hex, found once per size.
+std::string primeHex(size_t limbs) {
+    return BigInt::nextPrime(BigInt(randomHex(limbs, 7), 16)).toString(16);
+}
+
+size_t sizeArgument(const benchmark::State& state) {
+    return static_cast<size_t>(state.range(0));
+}
+
+// BigInt cases
+
+void bigintAdd(benchmark::State& state) {
+    size_t n = sizeArgument(state);
+    BigInt a(randomHex(n, 1), 16), b(randomHex(n, 2), 16), sum;
+    for (auto _ : state) {
+        sum = a + b;
+        benchmark::DoNotOptimize(sum);
+    }
+}
+
+void bigintMultiply(benchmark::State& state) {
+    size_t n = sizeArgument(state);
+    BigInt a(randomHex(n, 1), 16), b(randomHex(n, 2), 16), product;
+    for (auto _ : state) {
+        product = a * b;
+        benchmark::DoNotOptimize(product);
+    }
+}
+
+void bigintSquare(benchmark::State& state) {
+    size_t n = sizeArgument(state);
+    BigInt a(randomHex(n, 1), 16), square;
+    for (auto _ : state) {
+        square = a * a;
+        benchmark::DoNotOptimize(square);
+    }
+}
+
+// 2n limbs by n.
+void bigintDivide(benchmark::State& state) {
+    size_t n = sizeArgument(state);
+    BigInt a(randomHex(2 * n, 1), 16), d(randomHex(n, 2), 16), q, r;
+    for (auto _ : state) {
+        BigInt::divmod(a, d, q, r);
+        benchmark::DoNotOptimize(q);
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+// Full-width exponent against an odd modulus, including the context setup
+// that mpz_powm also does per call.
+void bigintModPow(benchmark::State& state) {
+    size_t n = sizeArgument(state);
+    BigInt m(oddHex(n, 1), 16), base(randomHex(n, 2), 16), exponent(randomHex(n, 3), 16);
+    base = base % m;
+    for (auto _ : state) {
+        BigInt result = BigInt::ModContext(m).modPow(base, exponent);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+void bigintToString(benchmark::State& state) {
+    size_t digits = sizeArgument(state);
+    BigInt a(randomDecimal(digits, 1));
+    for (auto _ : state) {
+        std::string text = a.toString();
+        benchmark::DoNotOptimize(text.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(digits));
+}
+
+void bigintParse(benchmark::State& state) {
+    size_t digits = sizeArgument(state);
+    std::string text = randomDecimal(digits, 1);
+    for (auto _ : state) {
+        BigInt a(text);
+        benchmark::DoNotOptimize(a);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(digits));
+}
+
+void bigintGcd(benchmark::State& state) {
+    size_t n = sizeArgument(state);
+    BigInt a(oddHex(n, 1), 16), b(oddHex(n, 2), 16);
+    for (auto _ : state) {
+        BigInt g = BigInt::gcd(a, b);
+        benchmark::DoNotOptimize(g);
+    }
+}
+
+// On primes, which take the whole test.
+void bigintIsPrime(benchmark::State& state) {
+    BigInt p(primeHex(sizeArgument(state)), 16);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BigInt::isPrime(p));
+    }
+}
+
+#ifdef BIGINT_BENCHMARK_GMP
+
+// GMP cases on the same operands.
+
+struct Mpz {
+    Mpz() { mpz_init(value); }
+    explicit Mpz(const std::string& text, int base = 16) { mpz_init_set_str(value, text.c_str(), base); }
+    ~Mpz() { mpz_clear(value); }
+    Mpz(const Mpz&) = delete;
+    Mpz& operator=(const Mpz&) = delete;
+
+    mpz_t value;
+};
+
+void gmpAdd(benchmark::State& state) {
+    size_t n = sizeArgument(state);
+    Mpz a(randomHex(n, 1)), b(randomHex(n, 2)), sum;
+    for (auto _ : state) {
+        mpz_add(sum.value, a.value, b.value);
+        benchmark::ClobberMemory();
+    }
+}
+
+void gmpMultiply(benchmark::State& state) {
+    size_t n = sizeArgument(state);
+    Mpz a(randomHex(n, 1)), b(randomHex(n, 2)), product;
+    for (auto _ : state) {
+        mpz_mul(product.value, a.value, b.value);
+        benchmark::ClobberMemory();
+    }
+}
+
+void gmpSquare(benchmark::State& state) {
+    size_t n = sizeArgument(state);
+    Mpz a(randomHex(n, 1)), square;
+    for (auto _ : state) {
+        mpz_mul(square.value, a.value, a.value);
+        benchmark::ClobberMemory();
+    }
+}
+
+void gmpDivide(benchmark::State& state) {
+    size_t n = sizeArgument(state);
+    Mpz a(randomHex(2 * n, 1)), d(randomHex(n, 2)), q, r;
+    for (auto _ : state) {
+        mpz_tdiv_qr(q.value, r.value, a.value, d.value);
+        benchmark::ClobberMemory();
+    }
+}
+
+void gmpModPow(benchmark::State& state) {
+    size_t n = sizeArgument(state);
+    Mpz m(oddHex(n, 1)), base(randomHex(n, 2)), exponent(randomHex(n, 3)), result;
+    mpz_mod(base.value, base.value, m.value);
+    for (auto _ : state) {
+        mpz_powm(result.value, base.value, exponent.value, m.value);
+        benchmark::ClobberMemory();
+    }
+}
+
+void gmpToString(benchmark::State& state) {
+    size_t digits = sizeArgument(state);
+    Mpz a(randomDecimal(digits, 1), 10);
+    std::string text(mpz_sizeinbase(a.value, 10) + 2, '\0');
+    for (auto _ : state) {
+        mpz_get_str(&text[0], 10, a.value);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(digits));
+}
+
+void gmpParse(benchmark::State& state) {
+    size_t digits = sizeArgument(state);
+    std::string text = randomDecimal(digits, 1);
+    for (auto _ : state) {
+        Mpz a(text, 10);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(digits));
+}
+
+void gmpGcd(benchmark::State& state) {
+    size_t n = sizeArgument(state);
+    Mpz a(oddHex(n, 1)), b(oddHex(n, 2)), g;
+    for (auto _ : state) {
+        mpz_gcd(g.value, a.value, b.value);
+        benchmark::ClobberMemory();
+    }
+}
+
+// GMP 6.2 runs Baillie-PSW for reps up to 24 and adds Miller-Rabin rounds
+// only beyond that, so this matches isPrime's test.
+void gmpIsPrime(benchmark::State& state) {
+    Mpz p(primeHex(sizeArgument(state)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mpz_probab_prime_p(p.value, 24));
+    }
+}
+
+#endif // BIGINT_BENCHMARK_GMP
+
+typedef void (*Case)(benchmark::State&);
+
+// Registers the BigInt case for each size, each followed by its GMP twin
+// when there is one.
+void registerCase(const std::string& name, Case bigint, Case gmp,
+                  const std::vector<size_t>& sizes) {
+    for (size_t size : sizes) {
+        int64_t argument = static_cast<int64_t>(size);
+        benchmark::RegisterBenchmark((name + "/BigInt").c_str(), bigint)
+            ->Arg(argument)->Unit(benchmark::kMicrosecond);
+#ifdef BIGINT_BENCHMARK_GMP
+        benchmark::RegisterBenchmark((name + "/GMP").c_str(), gmp)
+            ->Arg(argument)->Unit(benchmark::kMicrosecond);
+#else
+        (void)gmp;
+#endif
+    }
+}
+
+#ifdef BIGINT_BENCHMARK_GMP
+#define GMP_CASE(fn) fn
+#else
+#define GMP_CASE(fn) nullptr
+#endif
+
+void registerCases() {
+    std::vector<size_t> digitSizes;
+    for (size_t digits = 10; digits <= MAX_DIGITS; digits *= 10) {
+        digitSizes.push_back(digits);
+    }
+    std::vector<size_t> bitSizes;
+    for (size_t limbs = 1; limbs <= MAX_PRIME_LIMBS; limbs *= 2) {
+        bitSizes.push_back(limbs);
+    }
+    std::vector<size_t> modPowSizes;
+    for (size_t limbs = 1; limbs <= 128; limbs *= 2) {
+        modPowSizes.push_back(limbs);
+    }
+
+    registerCase("Add", bigintAdd, GMP_CASE(gmpAdd), limbSizes(MAX_LIMBS));
+    registerCase("Multiply", bigintMultiply, GMP_CASE(gmpMultiply), limbSizes(MAX_LIMBS));
+    registerCase("Square", bigintSquare, GMP_CASE(gmpSquare), limbSizes(MAX_LIMBS));
+    registerCase("Divide", bigintDivide, GMP_CASE(gmpDivide), limbSizes(MAX_LIMBS / 2));
+    registerCase("ModPow", bigintModPow, GMP_CASE(gmpModPow), modPowSizes);
+    registerCase("ToString", bigintToString, GMP_CASE(gmpToString), digitSizes);
+    registerCase("Parse", bigintParse, GMP_CASE(gmpParse), digitSizes);
+    registerCase("Gcd", bigintGcd, GMP_CASE(gmpGcd), limbSizes(MAX_GCD_LIMBS));
+    registerCase("IsPrime", bigintIsPrime, GMP_CASE(gmpIsPrime), bitSizes);
+}
+
+// Removes --bigint_threads=N from the arguments and applies it.
+void applyThreadsFlag(int& argc, char** argv) {
+    const char flag[] = "--bigint_threads=";
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], flag, sizeof(flag) - 1) == 0) {
+            BigInt::ParallelPolicy policy = BigInt::getParallelPolicy();
+            policy.threads = static_cast<unsigned>(std::strtoul(argv[i] + sizeof(flag) - 1, nullptr, 10));
+            BigInt::setParallelPolicy(policy);
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    applyThreadsFlag(argc, argv);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    registerCases();
+    benchmark::AddCustomContext("bigint_threads",
+                                std::to_string(BigInt::getParallelPolicy().threads));
+#ifdef BIGINT_BENCHMARK_GMP
+    benchmark::AddCustomContext("gmp_version", gmp_version);
+#endif
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,73 @@
+// Overhead of the constant-time Montgomery ladder relative to the
+// variable-time sliding-window path, for full-width secret exponents.
+//
+// Build: the bigint_constant_time_benchmark CMake target, or from this directory
+//        g++ -std=c++17 -O3 -I.. constant_time.cpp ../BigInt.cpp ../BigIntSerialization.cpp
+//        ../BigIntStats.cpp ../ConstantTime.cpp ../LimbKernels.cpp ../LimbPool.cpp
+//        ../ThreadPool.cpp -pthread -o constant_time
+
+#include "BigInt.h"
+#include "ConstantTime.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+namespace {
+
+BigInt randomBits(size_t bits, std::mt19937_64& rng) {
+    std::string str(bits, '0');
+    str[0] = '1';
+    for (size_t i = 1; i < bits; ++i) {
+        str[i] = static_cast<char>('0' + (rng() & 1));
+    }
+    return BigInt(str, 2);
+}
+
+template <typename Fn>
+double secondsPerCall(int repetitions, Fn fn) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repetitions; ++i) {
+        fn();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end - start).count() / repetitions;
+}
+
+// Keeps the optimizer from discarding benchmarked results.
+volatile size_t resultSink;
+
+void sink(size_t value) {
+    resultSink = value;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng(42);
+    const size_t sizes[] = {256, 1024, 2048, 4096};
+
+    std::printf("%8s %16s %16s %10s\n", "bits", "variable-time", "constant-time", "overhead");
+    for (size_t bits : sizes) {
+        BigInt modulus = randomBits(bits, rng);
+        if (modulus % BigInt::TWO == BigInt::ZERO) {
+            modulus += BigInt::ONE;
+        }
+        BigInt base = randomBits(bits - 1, rng);
+        BigInt exponent = randomBits(bits, rng);
+
+        BigInt::ModContext variable(modulus);
+        ConstantTimeModContext constant(modulus);
+        if (variable.modPow(base, exponent) != constant.modPow(base, exponent)) {
+            std::printf("mismatch at %zu bits\n", bits);
+            return 1;
+        }
+
+        int repetitions = bits >= 4096 ? 3 : bits >= 2048 ? 10 : 50;
+        double v = secondsPerCall(repetitions, [&] { sink(variable.modPow(base, exponent).size()); });
+        double c = secondsPerCall(repetitions, [&] { sink(constant.modPow(base, exponent).size()); });
+        std::printf("%8zu %13.3f ms %13.3f ms %9.2fx\n", bits, v * 1e3, c * 1e3, c / v);
+    }
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+// Allocation and bandwidth comparison between the packed 64-bit limb layout
+// used by BigInt and the previous one-decimal-digit-per-int layout.
+//
+// Build: the bigint_limb_layout_benchmark CMake target, or from this directory
+//        g++ -std=c++17 -O3 -I.. limb_layout.cpp ../BigInt.cpp ../BigIntSerialization.cpp
+//        ../BigIntStats.cpp ../ConstantTime.cpp ../LimbKernels.cpp ../LimbPool.cpp
+//        ../ThreadPool.cpp -pthread -o limb_layout
+
+#include "BigInt.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// Global allocation counters, updated by the replacement operator new below.
+static size_t allocationCount = 0;
+static size_t allocatedBytes = 0;
+
+void* operator new(size_t size) {
+    ++allocationCount;
+    allocatedBytes += size;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+// The previous representation: one base-10 digit per int, least significant
+// first. The kernels mirror the old BigInt implementation.
+struct DecimalDigits {
+    std::vector<int> digits;
+
+    explicit DecimalDigits(const std::string& str) {
+        for (size_t i = str.length(); i-- > 0;) {
+            digits.push_back(str[i] - '0');
+        }
+    }
+
+    DecimalDigits() {}
+
+    DecimalDigits operator+(const DecimalDigits& other) const {
+        DecimalDigits result;
+        int carry = 0;
+        size_t maxSize = std::max(digits.size(), other.digits.size());
+        for (size_t i = 0; i < maxSize || carry; ++i) {
+            int sum = carry;
+            if (i < digits.size()) sum += digits[i];
+            if (i < other.digits.size()) sum += other.digits[i];
+            result.digits.push_back(sum % 10);
+            carry = sum / 10;
+        }
+        return result;
+    }
+
+    DecimalDigits operator*(const DecimalDigits& other) const {
+        DecimalDigits result;
+        result.digits.resize(digits.size() + other.digits.size(), 0);
+        for (size_t i = 0; i < digits.size(); ++i) {
+            int carry = 0;
+            for (size_t j = 0; j < other.digits.size() || carry; ++j) {
+                long long product = result.digits[i + j] + carry;
+                if (j < other.digits.size()) {
+                    product += (long long)digits[i] * other.digits[j];
+                }
+                result.digits[i + j] = product % 10;
+                carry = product / 10;
+            }
+        }
+        while (result.digits.size() > 1 && result.digits.back() == 0) {
+            result.digits.pop_back();
+        }
+        return result;
+    }
+
+    std::string toString() const {
+        std::string result;
+        for (size_t i = digits.size(); i-- > 0;) {
+            result += '0' + digits[i];
+        }
+        return result;
+    }
+
+    size_t bytes() const { return digits.size() * sizeof(int); }
+};
+
+struct Measurement {
+    double seconds;
+    size_t allocations;
+    size_t bytes;
+};
+
+template <typename Fn>
+Measurement measure(int repetitions, Fn fn) {
+    size_t allocationsBefore = allocationCount;
+    size_t bytesBefore = allocatedBytes;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repetitions; ++i) {
+        fn();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return {std::chrono::duration<double>(end - start).count() / repetitions,
+            (allocationCount - allocationsBefore) / repetitions,
+            (allocatedBytes - bytesBefore) / repetitions};
+}
+
+std::string randomDigits(size_t count, std::mt19937_64& rng) {
+    std::string str(count, '0');
+    str[0] = static_cast<char>('1' + rng() % 9);
+    for (size_t i = 1; i < count; ++i) {
+        str[i] = static_cast<char>('0' + rng() % 10);
+    }
+    return str;
+}
+
+void printRow(const char* op, size_t digits, const char* layout, const Measurement& m,
+              size_t touchedBytes) {
+    double bandwidth = m.seconds > 0 ? touchedBytes / m.seconds / 1e9 : 0.0;
+    std::printf("%-10s %9zu  %-8s %12.3f us %8zu allocs %12zu B alloc %8.2f GB/s\n",
+                op, digits, layout, m.seconds * 1e6, m.allocations, m.bytes, bandwidth);
+}
+
+// Keeps the optimizer from discarding benchmarked results.
+volatile size_t resultSink;
+
+void sink(size_t value) {
+    resultSink = value;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng(42);
+    const size_t sizes[] = {100, 1000, 10000, 100000};
+
+    std::printf("%-10s %9s  %-8s %15s %15s %17s %12s\n",
+                "operation", "digits", "layout", "time/op", "allocs/op", "bytes/op", "touched");
+
+    for (size_t digits : sizes) {
+        std::string a = randomDigits(digits, rng);
+        std::string b = randomDigits(digits, rng);
+
+        DecimalDigits da(a), db(b);
+        BigInt ba(a), bb(b);
+        std::printf("\nfootprint %9zu  decimal  %12zu B   limbs %12zu B\n",
+                    digits, da.bytes(), ba.size() * sizeof(uint64_t));
+
+        int repetitions = digits >= 100000 ? 20 : 2000;
+        // Bytes read from both operands plus bytes written to the result.
+        Measurement m = measure(repetitions, [&] { sink((da + db).digits.size()); });
+        printRow("add", digits, "decimal", m, 3 * da.bytes());
+        m = measure(repetitions, [&] { sink((ba + bb).size()); });
+        printRow("add", digits, "limbs", m, 3 * ba.size() * sizeof(uint64_t));
+
+        if (digits <= 10000) {
+            repetitions = digits >= 10000 ? 1 : 20;
+            m = measure(repetitions, [&] { sink((da * db).digits.size()); });
+            printRow("multiply", digits, "decimal", m, 4 * da.bytes());
+            m = measure(repetitions, [&] { sink((ba * bb).size()); });
+            printRow("multiply", digits, "limbs", m, 4 * ba.size() * sizeof(uint64_t));
+        }
+
+        repetitions = digits >= 100000 ? 1 : 20;
+        m = measure(repetitions, [&] { sink(DecimalDigits(a).digits.size()); });
+        printRow("parse", digits, "decimal", m, digits + da.bytes());
+        m = measure(repetitions, [&] { sink(BigInt(a).size()); });
+        printRow("parse", digits, "limbs", m, digits + ba.size() * sizeof(uint64_t));
+
+        m = measure(repetitions, [&] { sink(da.toString().size()); });
+        printRow("toString", digits, "decimal", m, digits + da.bytes());
+        m = measure(repetitions, [&] { sink(ba.toString().size()); });
+        printRow("toString", digits, "limbs", m, digits + ba.size() * sizeof(uint64_t));
+    }
+
+    return 0;
+}
@@ -0,0 +1,895 @@
+#include "BigInt.h"
+#include "BigIntExpr.h"
+#include "BigIntSerialization.h"
+#include "BigIntStats.h"
+#include "ConstantTime.h"
+#include "LimbKernels.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Products are checked against an independent O(n^2) reference on limbs
+// taken out through hexadecimal text, and quotients by the division
+// identity, so a tier or kernel that goes wrong cannot vouch for itself.
+// CTest runs the suite once per BIGINT_KERNEL value as well as by default.
+
+namespace {
+
+typedef std::vector<uint64_t> LimbList;
+
+LimbList limbsOf(const BigInt& value) {
+    std::string hex = abs(value).toString(16);
+    LimbList limbs;
+    for (size_t end = hex.size(); end > 0 && hex != "0";) {
+        size_t begin = end >= 16 ? end - 16 : 0;
+        limbs.push_back(std::strtoull(hex.substr(begin, end - begin).c_str(), nullptr, 16));
+        end = begin;
+    }
+    return limbs;
+}
+
+BigInt fromLimbs(const LimbList& limbs, bool negative = false) {
+    static const char DIGITS[] = "0123456789abcdef";
+    std::string hex = negative ? "-" : "";
+    for (size_t i = limbs.size(); i-- > 0;) {
+        for (int shift = 60; shift >= 0; shift -= 4) {
+            hex += DIGITS[(limbs[i] >> shift) & 15];
+        }
+    }
+    return hex.empty() || hex == "-" ? BigInt() : BigInt(hex, 16);
+}
+
+// Random value of exactly `limbs` limbs, with runs of all-ones and zero
+// limbs mixed in to exercise carry chains.
+BigInt randomValue(std::mt19937_64& rng, size_t limbs, bool negative = false) {
+    LimbList value(limbs);
+    for (uint64_t& limb : value) {
+        switch (rng() % 8) {
+            case 0: limb = ~uint64_t(0); break;
+            case 1: limb = 0; break;
+            default: limb = rng(); break;
+        }
+    }
+    if (limbs) {
+        value.back() |= uint64_t(1) << 63;
+    }
+    return fromLimbs(value, negative);
+}
+
+BigInt referenceMultiply(const BigInt& a, const BigInt& b) {
+    LimbList x = limbsOf(a), y = limbsOf(b), r(x.size() + y.size(), 0);
+    for (size_t i = 0; i < x.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < y.size(); ++j) {
+            unsigned __int128 t = static_cast<unsigned __int128>(x[i]) * y[j] + r[i + j] + carry;
+            r[i + j] = static_cast<uint64_t>(t);
+            carry = static_cast<uint64_t>(t >> 64);
+        }
+        r[i + y.size()] = carry;
+    }
+    while (!r.empty() && r.back() == 0) {
+        r.pop_back();
+    }
+    return fromLimbs(r, a.isNegative() != b.isNegative() && !r.empty());
+}
+
+void expectDivision(const BigInt& a, const BigInt& d) {
+    BigInt q, r;
+    BigInt::divmod(a, d, q, r);
+    EXPECT_EQ(q * d + r, a);
+    EXPECT_LT(abs(r), abs(d));
+    EXPECT_TRUE(r.isZero() || r.isNegative() == a.isNegative());
+}
+
+uint64_t tierCalls(BigIntStats::Operation operation) {
+    return BigIntStats::snapshot()[operation].calls;
+}
+
+// Restores the process-wide settings the tests change.
+class BigIntTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        thresholds = BigInt::getMultiplyThresholds();
+        policy = BigInt::getParallelPolicy();
+    }
+    void TearDown() override {
+        BigInt::setMultiplyThresholds(thresholds);
+        BigInt::setParallelPolicy(policy);
+    }
+
+    BigInt::MultiplyThresholds thresholds;
+    BigInt::ParallelPolicy policy;
+    std::mt19937_64 rng{20240611};
+};
+
+} // namespace
+
+TEST_F(BigIntTest, MultiplicationTiersMatchReference) {
+    struct Shape {
+        size_t an, bn;
+        BigIntStats::Operation tier;
+    };
+    // Shapes either side of the default thresholds, which follow the active
+    // kernel, then unbalanced ones.
+    size_t k = thresholds.karatsuba, t = thresholds.toom3, n = thresholds.ntt;
+    const Shape shapes[] = {
+        {1, 1, BigIntStats::Operation::MultiplySchoolbook},
+        {k - 1, k / 2 + 1, BigIntStats::Operation::MultiplySchoolbook},
+        {k, k, BigIntStats::Operation::MultiplyKaratsuba},
+        {t - 1, t - 20, BigIntStats::Operation::MultiplyKaratsuba},
+        {t, t, BigIntStats::Operation::MultiplyToom3},
+        {2 * t + 30, 2 * t, BigIntStats::Operation::MultiplyToom3},
+        {n + 100, n, BigIntStats::Operation::MultiplyNtt},
+        {10 * k, k + 1, BigIntStats::Operation::MultiplyKaratsuba},
+        {n + 2000, n + 500, BigIntStats::Operation::MultiplyNtt},
+    };
+    for (const Shape& shape : shapes) {
+        BigInt a = randomValue(rng, shape.an, rng() & 1);
+        BigInt b = randomValue(rng, shape.bn, rng() & 1);
+        uint64_t before = tierCalls(shape.tier);
+        EXPECT_EQ(a * b, referenceMultiply(a, b)) << shape.an << " x " << shape.bn;
+        if (BigIntStats::compiledIn()) {
+            EXPECT_GT(tierCalls(shape.tier), before) << BigIntStats::name(shape.tier);
+        }
+        BigInt product = a;
+        product *= b;
+        EXPECT_EQ(product, a * b);
+    }
+}
+
+TEST_F(BigIntTest, SquaringTiersMatchReference) {
+    for (size_t n : {1, 5, 33, 64, 251, 600, 4200}) {
+        BigInt a = randomValue(rng, n);
+        EXPECT_EQ(BigInt::square(a), referenceMultiply(a, a)) << n;
+        EXPECT_EQ(a * a, referenceMultiply(a, a)) << n;
+    }
+}
+
+TEST_F(BigIntTest, LoweredThresholdsReachEveryTierOnSmallOperands) {
+    BigInt::setMultiplyThresholds({4, 8, 16});
+    for (size_t n : {3, 5, 9, 12, 17, 40, 100}) {
+        for (size_t m : {n, n / 2 + 1, 2 * n + 3}) {
+            BigInt a = randomValue(rng, n, true), b = randomValue(rng, m);
+            EXPECT_EQ(a * b, referenceMultiply(a, b)) << n << " x " << m;
+        }
+    }
+    EXPECT_THROW(BigInt::setMultiplyThresholds({3, 8, 16}), InvalidInputException);
+}
+
+TEST_F(BigIntTest, DivisionTiersSatisfyTheIdentity) {
+    const size_t shapes[][2] = {
+        {1, 1}, {5, 1}, {40, 1}, {2, 2}, {30, 7}, {300, 150}, {1000, 999},
+        // Newton division: divisor and quotient both past 1200 limbs.
+        {2600, 1250}, {4000, 1300},
+    };
+    for (const auto& shape : shapes) {
+        BigInt a = randomValue(rng, shape[0], rng() & 1);
+        BigInt d = randomValue(rng, shape[1], rng() & 1);
+        expectDivision(a, d);
+        expectDivision(d, a);
+    }
+    if (BigIntStats::compiledIn()) {
+        EXPECT_GT(tierCalls(BigIntStats::Operation::DivideNewton), 0u);
+        EXPECT_GT(tierCalls(BigIntStats::Operation::DivideKnuth), 0u);
+    }
+}
+
+TEST_F(BigIntTest, SingleLimbDivisorsUseReciprocalsExactly) {
+    // Divisors around powers of two and at the top of the limb stress the
+    // normalization and correction steps of the reciprocal division.
+    std::vector<uint64_t> divisors = {1, 2, 3, 7, 10, 1000000007, ~uint64_t(0), uint64_t(1) << 63,
+                                      (uint64_t(1) << 63) + 1, (uint64_t(1) << 32) - 1};
+    for (int i = 0; i < 20; ++i) {
+        divisors.push_back(rng() >> (rng() % 64));
+    }
+    for (uint64_t divisor : divisors) {
+        if (divisor == 0) {
+            continue;
+        }
+        BigInt a = randomValue(rng, 1 + rng() % 50, rng() & 1);
+        BigInt d = fromLimbs({divisor});
+        expectDivision(a, d);
+        BigInt quotient;
+        int64_t remainder = BigInt::divmodSmall(a, static_cast<int64_t>(divisor >> 1) | 1, quotient);
+        EXPECT_EQ(quotient * BigInt(static_cast<long long>(divisor >> 1) | 1) + BigInt(remainder), a);
+    }
+}
+
+TEST_F(BigIntTest, DivisionModesAndAliasing) {
+    BigInt q, r;
+    BigInt::divmod(BigInt(-7), BigInt(2), q, r, BigInt::DivisionMode::Floor);
+    EXPECT_EQ(q, BigInt(-4));
+    EXPECT_EQ(r, BigInt(1));
+    BigInt::divmod(BigInt(-7), BigInt(-2), q, r, BigInt::DivisionMode::Euclidean);
+    EXPECT_EQ(q, BigInt(4));
+    EXPECT_EQ(r, BigInt(1));
+    EXPECT_THROW(BigInt::divmod(BigInt(7), BigInt(2), q, q), InvalidInputException);
+    EXPECT_THROW(BigInt(1) / BigInt(0), DivisionByZeroException);
+}
+
+TEST_F(BigIntTest, EveryKernelMatchesPortable) {
+    const LimbKernels* portable = LimbKernels::find("portable");
+    ASSERT_NE(portable, nullptr);
+    for (const char* name : {"adx", "ifma"}) {
+        const LimbKernels* kernels = LimbKernels::find(name);
+        if (!kernels) {
+            continue;
+        }
+        for (size_t an = 1; an <= 70; an += 1 + an / 8) {
+            for (size_t bn = 1; bn <= an; bn += 1 + bn / 4) {
+                LimbList a(an), b(bn), expected(an + bn), actual(an + bn);
+                for (uint64_t& limb : a) limb = rng() | (rng() & 1 ? ~uint64_t(0) : 0);
+                for (uint64_t& limb : b) limb = rng();
+                portable->multiply(expected.data(), a.data(), an, b.data(), bn);
+                kernels->multiply(actual.data(), a.data(), an, b.data(), bn);
+                EXPECT_EQ(actual, expected) << name << " multiply " << an << " x " << bn;
+
+                LimbList sum = a, portableSum = a;
+                uint64_t m = rng();
+                EXPECT_EQ(kernels->addMultiple(sum.data(), a.data(), an, m),
+                          portable->addMultiple(portableSum.data(), a.data(), an, m));
+                EXPECT_EQ(sum, portableSum) << name << " addMultiple " << an;
+            }
+            LimbList a(an), b(an), r1(an), r2(an);
+            for (size_t i = 0; i < an; ++i) {
+                // Complementary limbs make carries and borrows run through.
+                a[i] = rng();
+                b[i] = rng() & 1 ? ~a[i] : rng();
+            }
+            EXPECT_EQ(kernels->add(r1.data(), a.data(), b.data(), an),
+                      portable->add(r2.data(), a.data(), b.data(), an));
+            EXPECT_EQ(r1, r2) << name << " add " << an;
+            EXPECT_EQ(kernels->subtract(r1.data(), a.data(), b.data(), an),
+                      portable->subtract(r2.data(), a.data(), b.data(), an));
+            EXPECT_EQ(r1, r2) << name << " subtract " << an;
+        }
+    }
+}
+
+TEST_F(BigIntTest, ActiveKernelHonoursOverride) {
+    const char* requested = std::getenv("BIGINT_KERNEL");
+    if (!requested || !LimbKernels::find(requested)) {
+        GTEST_SKIP() << "no runnable BIGINT_KERNEL requested";
+    }
+    EXPECT_STREQ(LimbKernels::active().name, requested);
+}
+
+TEST_F(BigIntTest, BitwiseOperatorsUseTwosComplement) {
+    const long long samples[] = {0, 1, -1, 2, -2, 5, -6, 255, -256, 0x5555, -0x7777,
+                                 (1LL << 40) + 3, -(1LL << 40) - 9, 1LL << 62, -(1LL << 62)};
+    for (long long x : samples) {
+        for (long long y : samples) {
+            EXPECT_EQ(BigInt(x) & BigInt(y), BigInt(x & y)) << x << " & " << y;
+            EXPECT_EQ(BigInt(x) | BigInt(y), BigInt(x | y)) << x << " | " << y;
+            EXPECT_EQ(BigInt::bitwiseXor(BigInt(x), BigInt(y)), BigInt(x ^ y)) << x << " ^ " << y;
+        }
+        EXPECT_EQ(~BigInt(x), BigInt(~x));
+        for (size_t k : {0, 1, 7, 63, 64, 65}) {
+            EXPECT_EQ(BigInt(x) >> k, BigInt(k > 62 ? (x < 0 ? -1 : 0) : x >> k)) << x << " >> " << k;
+        }
+    }
+
+    for (int i = 0; i < 40; ++i) {
+        BigInt a = randomValue(rng, 1 + rng() % 9, rng() & 1);
+        BigInt b = randomValue(rng, 1 + rng() % 9, rng() & 1);
+        EXPECT_EQ((a & b) + (a | b), a + b);
+        EXPECT_EQ(BigInt::bitwiseXor(a, b), (a | b) - (a & b));
+        EXPECT_EQ(~a, -a - BigInt(1));
+        size_t k = rng() % 200;
+        BigInt power = BigInt(1) << k;
+        EXPECT_EQ(a << k, a * power);
+        EXPECT_EQ(a >> k, BigInt::divmod(a, power, BigInt::DivisionMode::Floor).first);
+        for (size_t bit = 0; bit < 10; ++bit) {
+            size_t index = rng() % 700;
+            EXPECT_EQ(a.testBit(index), !((a >> index) & BigInt(1)).isZero());
+        }
+    }
+}
+
+TEST_F(BigIntTest, MovesAcrossMemoryResourcesCopy) {
+    static_assert(std::is_nothrow_move_constructible<BigInt>::value, "moves hand over storage");
+    static_assert(!std::is_nothrow_move_assignable<BigInt>::value,
+                  "cross-resource move assignment copies and may throw");
+    BigInt outside;
+    BigInt expected = randomValue(rng, 40, true);
+    {
+        BigInt::PoolScope scope;
+        BigInt inside = expected;
+        outside = std::move(inside);
+    }
+    // The pool has been released, so outside must own a copy.
+    EXPECT_EQ(outside, expected);
+    EXPECT_EQ(outside * BigInt(3), expected + expected + expected);
+}
+
+TEST_F(BigIntTest, WideNativeIntegersConvertExactly) {
+    __int128 wide = static_cast<__int128>(1) << 70;
+    EXPECT_EQ(BigInt(1) + wide, (BigInt(1) << 70) + BigInt(1));
+    EXPECT_EQ(BigInt(3) * wide, BigInt(3) << 70);
+    EXPECT_EQ(BigInt(-wide), -(BigInt(1) << 70));
+    unsigned __int128 top = ~static_cast<unsigned __int128>(0);
+    EXPECT_EQ(BigInt(top), (BigInt(1) << 128) - BigInt(1));
+    __int128 lowest = -static_cast<__int128>(top >> 1) - 1;
+    EXPECT_EQ(BigInt(lowest), -(BigInt(1) << 127));
+    BigInt x(5);
+    x *= 7u;
+    x -= static_cast<short>(-3);
+    EXPECT_EQ(x, BigInt(38));
+}
+
+TEST_F(BigIntTest, RadixConversionRoundTrips) {
+    for (size_t n : {1, 3, 20, 300, 3000}) {
+        BigInt a = randomValue(rng, n, rng() & 1);
+        for (int base : {10, 16, 7, 36, 2}) {
+            EXPECT_EQ(BigInt(a.toString(base), base), a) << n << " limbs in base " << base;
+        }
+        std::string decimal = a.toString();
+        EXPECT_EQ(a.getDigitCount(), static_cast<int>(decimal.size() - (a.isNegative() ? 1 : 0)));
+    }
+    EXPECT_EQ(BigInt(0).getDigitCount(), 1);
+    EXPECT_EQ(BigInt("1000000000000000000000").getDigitCount(), 22);
+    EXPECT_EQ(BigInt("999999999999999999999").getDigitCount(), 21);
+}
+
+TEST_F(BigIntTest, ParallelPathsMatchReferences) {
+    // References come from the serial schoolbook product, the division
+    // identity and running products of native factors, so a parallel result
+    // is never only compared with itself.
+    BigInt a = randomValue(rng, 6000), b = randomValue(rng, 5000), c = randomValue(rng, 700);
+    BigInt product = referenceMultiply(a, b), toomProduct = referenceMultiply(c, c);
+    std::string text = a.toString();
+    BigInt prime = BigInt::nextPrime(BigInt(1) << 300);
+    std::vector<BigInt> factorials;
+    BigInt running(1);
+    for (int n = 1; n <= 30000; ++n) {
+        running *= n;
+        if (n % 5000 == 0) {
+            factorials.push_back(running);
+        }
+    }
+
+    BigInt::setParallelPolicy({4, 64});
+    EXPECT_EQ(a * b, product);
+    EXPECT_EQ(c * c, toomProduct);
+    EXPECT_EQ(BigInt::square(c), toomProduct);
+    expectDivision(a, c);
+    EXPECT_EQ(a.toString(), text);
+    EXPECT_EQ(BigInt(text), a);
+    EXPECT_EQ(BigInt::factorial(30000), factorials[5]);
+    EXPECT_EQ(BigInt::binomial(30000, 10000), factorials[5] / (factorials[1] * factorials[3]));
+    EXPECT_EQ(BigInt::catalan(15000) * BigInt(15001), factorials[5] / (factorials[2] * factorials[2]));
+    BigInt parallelPrime = BigInt::nextPrime(BigInt(1) << 300, 4);
+    EXPECT_EQ(parallelPrime, prime);
+    EXPECT_TRUE(BigInt::isPrime(parallelPrime));
+}
+
+TEST_F(BigIntTest, LazyExpressionsMatchEagerEvaluation) {
+    BigInt a = randomValue(rng, 40, true), b = randomValue(rng, 35), c = randomValue(rng, 3);
+    BigInt d = randomValue(rng, 50, true), e = randomValue(rng, 20), modulus = randomValue(rng, 10);
+    BigInt r = BigIntExpr::lazy(a) * b + BigIntExpr::lazy(c) * d - e;
+    EXPECT_EQ(r, a * b + c * d - e);
+    BigInt expected = r * b % modulus;
+    BigIntExpr::assign(r, BigIntExpr::lazy(r) * b % modulus);
+    EXPECT_EQ(r, expected);
+    BigInt s;
+    BigIntExpr::assign(s, e - BigIntExpr::lazy(a) * d);
+    EXPECT_EQ(s, e - a * d);
+}
+
+TEST_F(BigIntTest, ConstantTimeModPowReducesAnyBase) {
+    BigInt modulus = randomValue(rng, 4) + BigInt(1);
+    if (modulus.isZero() || (modulus % BigInt(2)).isZero()) {
+        modulus += BigInt(1);
+    }
+    ConstantTimeModContext context(modulus);
+    BigInt exponent = randomValue(rng, 2);
+    BigInt::ModContext reference(modulus);
+    for (size_t limbs : {0, 1, 4, 9}) {
+        BigInt base = randomValue(rng, limbs);
+        EXPECT_EQ(context.modPow(base, exponent), reference.modPow(base % modulus, exponent));
+    }
+    EXPECT_EQ(context.modPow(modulus, exponent), BigInt(0));
+}
+
+TEST_F(BigIntTest, PrimalityAgreesWithSieveAndRejectsPseudoprimes) {
+    const uint32_t LIMIT = 1 << 17;
+    std::vector<bool> composite(LIMIT, false);
+    for (uint32_t i = 2; i * i < LIMIT; ++i) {
+        for (uint32_t j = i * i; !composite[i] && j < LIMIT; j += i) {
+            composite[j] = true;
+        }
+    }
+    for (uint32_t n = 0; n < LIMIT; ++n) {
+        EXPECT_EQ(BigInt::isPrime(BigInt(static_cast<long long>(n))), n >= 2 && !composite[n]) << n;
+    }
+
+    // Strong pseudoprimes to many small bases, below and above 2^64,
+    // Carmichael numbers, and strong Lucas pseudoprimes under Selfridge's d.
+    for (const char* n : {"3215031751", "3825123056546413051", "318665857834031151167461",
+                          "3317044064679887385961981", "561", "41041", "825265", "321197185",
+                          "5394826801", "5459", "5777", "10877", "16109", "18971",
+                          "147573952589676412927"}) {
+        EXPECT_FALSE(BigInt::isPrime(BigInt(n))) << n;
+    }
+    EXPECT_TRUE(BigInt::ModContext(BigInt("3317044064679887385961981")).isStrongProbablePrime(BigInt(41)));
+    EXPECT_TRUE(BigInt::ModContext(BigInt(5459)).isStrongLucasProbablePrime(-7));
+    EXPECT_TRUE(BigInt::ModContext(BigInt(5777)).isStrongLucasProbablePrime(5));
+
+    // Prime squares either side of 2^64, where the single-limb Miller-Rabin
+    // hands over to Baillie-PSW.
+    BigInt below(4294967291LL), above(4294967311LL);
+    EXPECT_TRUE(BigInt::isPrime(below));
+    EXPECT_TRUE(BigInt::isPrime(above));
+    EXPECT_FALSE(BigInt::isPrime(below * below));
+    EXPECT_FALSE(BigInt::isPrime(above * above));
+    EXPECT_TRUE(BigInt::isPrime(BigInt("18446744073709551557")));
+    EXPECT_TRUE(BigInt::isPrime((BigInt(1) << 64) + BigInt(13)));
+    EXPECT_FALSE(BigInt::isPrime((BigInt(1) << 64) + BigInt(1)));
+
+    BigInt m127 = (BigInt(1) << 127) - BigInt(1), m521 = (BigInt(1) << 521) - BigInt(1);
+    EXPECT_TRUE(BigInt::isPrime(m127));
+    EXPECT_TRUE(BigInt::isPrime(m521));
+    EXPECT_FALSE(BigInt::isPrime(m127 * m521));
+    EXPECT_FALSE(BigInt::isPrime((BigInt(1) << 523) - BigInt(1)));
+    EXPECT_FALSE(BigInt::isPrime(-m127));
+
+    EXPECT_EQ(BigInt::nextPrime(BigInt(1) << 64), (BigInt(1) << 64) + BigInt(13));
+    EXPECT_EQ(BigInt::nextPrime(BigInt(5459)), BigInt(5471));
+    std::mt19937_64 primeRng(7);
+    BigInt random = BigInt::randomPrime(200, primeRng);
+    EXPECT_EQ(random.bitLength(), 200u);
+    EXPECT_TRUE(BigInt::isPrime(random));
+}
+
+TEST_F(BigIntTest, SerializationRoundTripsAndRejectsMalformedRecords) {
+    // The documented layout, written out by hand for -(2^64 + 5).
+    const uint8_t expected[] = {'B', 'I', 'G', 'N', 1, 1, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0,
+                                5, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0};
+    BigInt sample = -((BigInt(1) << 64) + BigInt(5));
+    std::vector<uint8_t> bytes(sample.serializedSize());
+    ASSERT_EQ(sample.serialize(bytes.data(), bytes.size()), sizeof(expected));
+    EXPECT_EQ(0, std::memcmp(bytes.data(), expected, sizeof(expected)));
+    EXPECT_THROW(sample.serialize(bytes.data(), bytes.size() - 1), InvalidInputException);
+
+    // Back-to-back records in one buffer, each reporting its own length.
+    std::vector<BigInt> values = {BigInt(), BigInt(1), BigInt(-7), randomValue(rng, 3, true),
+                                  randomValue(rng, 50)};
+    std::vector<uint8_t> packed;
+    for (const BigInt& value : values) {
+        size_t offset = packed.size();
+        packed.resize(offset + value.serializedSize());
+        value.serialize(packed.data() + offset, value.serializedSize());
+    }
+    size_t offset = 0;
+    for (const BigInt& value : values) {
+        size_t consumed = 0;
+        EXPECT_EQ(BigInt::deserialize(packed.data() + offset, packed.size() - offset, &consumed), value);
+        EXPECT_EQ(consumed, value.serializedSize());
+        EXPECT_EQ(consumed % 8, 0u);
+        offset += consumed;
+    }
+    EXPECT_EQ(offset, packed.size());
+
+    // The stream classes, with chunks smaller than the values, read the
+    // same bytes and stop cleanly at the end.
+    std::stringstream stream;
+    BigIntWriter writer(stream, 3);
+    for (const BigInt& value : values) {
+        writer.write(value);
+    }
+    EXPECT_EQ(stream.str(), std::string(packed.begin(), packed.end()));
+    BigIntReader reader(stream, 2);
+    BigInt value;
+    for (const BigInt& expectedValue : values) {
+        ASSERT_TRUE(reader.read(value));
+        EXPECT_EQ(value, expectedValue);
+    }
+    EXPECT_FALSE(reader.read(value));
+
+    auto rejects = [](std::vector<uint8_t> record) {
+        EXPECT_THROW(BigInt::deserialize(record.data(), record.size()), InvalidInputException);
+        std::stringstream in(std::string(record.begin(), record.end()));
+        BigInt out;
+        EXPECT_THROW(BigIntReader(in).read(out), InvalidInputException);
+    };
+    std::vector<uint8_t> record(bytes);
+    record[0] = 'X';
+    rejects(record);
+    record = bytes;
+    record[4] = 2;
+    rejects(record);
+    record = bytes;
+    record[5] = 3;
+    rejects(record);
+    record = bytes;
+    record[6] = 1;
+    rejects(record);
+    // Negative zero.
+    rejects({'B', 'I', 'G', 'N', 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+    // Leading zero limb.
+    record = bytes;
+    record[24] = 0;
+    rejects(record);
+    // Truncated inside the header and inside the limbs, and a length prefix
+    // far beyond the data.
+    rejects(std::vector<uint8_t>(bytes.begin(), bytes.begin() + 10));
+    rejects(std::vector<uint8_t>(bytes.begin(), bytes.end() - 1));
+    record = bytes;
+    record[15] = 0x80;
+    rejects(record);
+}
+
+TEST_F(BigIntTest, FactorizationReachesEveryStage) {
+    typedef std::vector<std::pair<BigInt, int>> Factors;
+    auto expectFactors = [](const BigInt& n, const Factors& expected) {
+        EXPECT_EQ(BigInt::primeFactorization(n), expected) << n;
+    };
+    BigInt m61 = (BigInt(1) << 61) - BigInt(1), m127 = (BigInt(1) << 127) - BigInt(1);
+    EXPECT_TRUE(BigInt::primeFactorization(BigInt(1)).empty());
+    // Sieve primes and a wheel prime, with a negative sign dropped.
+    expectFactors(-BigInt(32 * 27 * 4093LL) * BigInt(65521),
+                  {{BigInt(2), 5}, {BigInt(3), 3}, {BigInt(4093), 1}, {BigInt(65521), 1}});
+    // Single-limb semiprimes for the native rho, one past 2^63.
+    expectFactors(BigInt(1073741789LL) * BigInt(1073741827LL),
+                  {{BigInt(1073741789LL), 1}, {BigInt(1073741827LL), 1}});
+    expectFactors(BigInt(4294967291LL) * BigInt(4294967279LL),
+                  {{BigInt(4294967279LL), 1}, {BigInt(4294967291LL), 1}});
+    // Multi-limb: a 33-bit factor within the rho budget, a prime power, and
+    // a 51-bit factor that only ECM finds.
+    expectFactors(BigInt(4294967311LL) * m61 * BigInt(65537),
+                  {{BigInt(65537), 1}, {BigInt(4294967311LL), 1}, {m61, 1}});
+    expectFactors(m61 * m61 * m61, {{m61, 3}});
+    BigInt p50(1125899906842679LL);
+    expectFactors(p50 * m127, {{p50, 1}, {m127, 1}});
+    expectFactors(m127, {{m127, 1}});
+
+    std::vector<BigInt::FactorizationProgress::Stage> stages;
+    auto record = [&stages](const BigInt::FactorizationProgress& report) {
+        stages.push_back(report.stage);
+        return true;
+    };
+    BigInt::primeFactorization(BigInt(1073741789LL) * BigInt(1073741827LL), record);
+    EXPECT_EQ(stages.front(), BigInt::FactorizationProgress::TRIAL_DIVISION);
+    EXPECT_NE(std::count(stages.begin(), stages.end(), BigInt::FactorizationProgress::POLLARD_RHO), 0);
+    stages.clear();
+    BigInt::primeFactorization(p50 * m127, record);
+    EXPECT_NE(std::count(stages.begin(), stages.end(), BigInt::FactorizationProgress::ECM), 0);
+
+    // Cancelling from either rho stage throws.
+    for (const BigInt& n : {BigInt(1073741789LL) * BigInt(1073741827LL), p50 * m127}) {
+        auto cancel = [](const BigInt::FactorizationProgress& report) {
+            return report.stage != BigInt::FactorizationProgress::POLLARD_RHO;
+        };
+        EXPECT_THROW(BigInt::primeFactorization(n, cancel), OperationCancelledException) << n;
+    }
+}
+
+TEST_F(BigIntTest, GcdFamilyMatchesEuclid) {
+    auto euclid = [](BigInt a, BigInt b) {
+        a = abs(a);
+        b = abs(b);
+        while (!b.isZero()) {
+            BigInt r = a % b;
+            a = b;
+            b = r;
+        }
+        return a;
+    };
+    for (int i = 0; i < 200; ++i) {
+        uint64_t x = rng() >> (rng() % 64), y = rng() >> (rng() % 64);
+        uint64_t g = x, h = y;
+        while (h) {
+            uint64_t r = g % h;
+            g = h;
+            h = r;
+        }
+        EXPECT_EQ(BigInt::gcd(fromLimbs({x}), fromLimbs({y})), fromLimbs({g})) << x << ", " << y;
+    }
+    // A shared factor on top of random cofactors, for Lehmer's algorithm.
+    for (size_t n : {2, 3, 8, 40, 200}) {
+        BigInt common = randomValue(rng, 1 + rng() % n);
+        BigInt a = randomValue(rng, n, rng() & 1) * common;
+        BigInt b = randomValue(rng, 1 + rng() % n, rng() & 1) * common;
+        BigInt g = BigInt::gcd(a, b);
+        EXPECT_EQ(g, euclid(a, b)) << n;
+        EXPECT_TRUE((g % common).isZero());
+        EXPECT_EQ(BigInt::lcm(a, b), abs(a) / g * abs(b));
+
+        BigInt x, y;
+        EXPECT_EQ(BigInt::extendedGcd(a, b, x, y), g);
+        EXPECT_EQ(a * x + b * y, g);
+        EXPECT_LE(abs(x) * g * BigInt(2), abs(b)) << n;
+    }
+    BigInt x, y;
+    EXPECT_EQ(BigInt::extendedGcd(BigInt(-12), BigInt(0), x, y), BigInt(12));
+    EXPECT_EQ(x, BigInt(-1));
+    EXPECT_EQ(y, BigInt(0));
+    EXPECT_EQ(BigInt::extendedGcd(BigInt(240), BigInt(46), x, y), BigInt(2));
+    EXPECT_EQ(x, BigInt(-9));
+    EXPECT_EQ(y, BigInt(47));
+    EXPECT_EQ(BigInt::gcd(BigInt(0), BigInt(0)), BigInt(0));
+    EXPECT_EQ(BigInt::lcm(BigInt(0), BigInt(5)), BigInt(0));
+    EXPECT_EQ(BigInt::lcm(BigInt(-4), BigInt(6)), BigInt(12));
+    // gcd(F(m), F(n)) = F(gcd(m, n)), with F(150) written out.
+    EXPECT_EQ(BigInt::gcd(BigInt::fibonacci(300), BigInt::fibonacci(450)),
+              BigInt("9969216677189303386214405760200"));
+
+    BigInt modulus = randomValue(rng, 5) + BigInt(1);
+    for (int i = 0; i < 20; ++i) {
+        BigInt a = randomValue(rng, 1 + rng() % 8, rng() & 1);
+        if (BigInt::gcd(a, modulus) != BigInt(1)) {
+            EXPECT_THROW(BigInt::modInverse(a, modulus), InvalidInputException);
+            continue;
+        }
+        BigInt inverse = BigInt::modInverse(a, modulus);
+        EXPECT_FALSE(inverse.isNegative());
+        EXPECT_LT(inverse, modulus);
+        EXPECT_EQ(BigInt::divmod(a * inverse, modulus, BigInt::DivisionMode::Euclidean).second, BigInt(1));
+    }
+    EXPECT_EQ(BigInt::modInverse(BigInt(3), BigInt(11)), BigInt(4));
+    EXPECT_EQ(BigInt::modInverse(BigInt(-3), BigInt(11)), BigInt(7));
+    EXPECT_THROW(BigInt::modInverse(BigInt(6), BigInt(9)), InvalidInputException);
+    EXPECT_THROW(BigInt::modInverse(BigInt(3), BigInt(-11)), InvalidInputException);
+}
+
+TEST_F(BigIntTest, RootsBracketTheirOperands) {
+    for (size_t n : {1, 2, 5, 17, 80, 300}) {
+        BigInt a = randomValue(rng, n);
+        BigInt root = BigInt::sqrt(a);
+        EXPECT_LE(root * root, a);
+        EXPECT_GT((root + BigInt(1)) * (root + BigInt(1)), a);
+        auto rootRemainder = BigInt::isqrtrem(a);
+        EXPECT_EQ(rootRemainder.first, root);
+        EXPECT_EQ(rootRemainder.second, a - root * root);
+        EXPECT_EQ(BigInt::sqrt(root * root), root);
+        for (int k : {3, 4, 5, 7, 64, 65}) {
+            BigInt r = BigInt::nthRoot(a, k);
+            EXPECT_LE(BigInt::pow(r, BigInt(k)), a) << n << " limbs, k = " << k;
+            EXPECT_GT(BigInt::pow(r + BigInt(1), BigInt(k)), a) << n << " limbs, k = " << k;
+            EXPECT_EQ(BigInt::nthRoot(BigInt::pow(r, BigInt(k)), k), r);
+        }
+    }
+    EXPECT_EQ(BigInt::sqrt(BigInt(2) * BigInt::pow(BigInt(10), BigInt(100))),
+              BigInt("141421356237309504880168872420969807856967187537694"));
+    EXPECT_EQ(BigInt::nthRoot(BigInt::pow(BigInt(10), BigInt(200)) + BigInt(12345), 7),
+              BigInt("37275937203149401661724906094"));
+    EXPECT_EQ(BigInt::sqrt(BigInt(0)), BigInt(0));
+    EXPECT_EQ(BigInt::sqrt(fromLimbs({~uint64_t(0)})), BigInt(4294967295LL));
+    EXPECT_THROW(BigInt::sqrt(BigInt(-1)), InvalidInputException);
+
+    // Odd roots of negative numbers truncate toward zero.
+    EXPECT_EQ(BigInt::nthRoot(BigInt(-9), 3), BigInt(-2));
+    EXPECT_EQ(BigInt::nthRoot(BigInt(-8), 3), BigInt(-2));
+    EXPECT_EQ(BigInt::nthRoot(-BigInt::pow(BigInt(10), BigInt(60)) - BigInt(1), 3),
+              -BigInt::pow(BigInt(10), BigInt(20)));
+    EXPECT_THROW(BigInt::nthRoot(BigInt(-9), 2), InvalidInputException);
+    EXPECT_THROW(BigInt::nthRoot(BigInt(9), 0), InvalidInputException);
+
+    BigInt root;
+    int exponent = 0;
+    EXPECT_TRUE(BigInt::isPerfectPower(BigInt::pow(BigInt(6), BigInt(12)), &root, &exponent));
+    EXPECT_EQ(root, BigInt(6));
+    EXPECT_EQ(exponent, 12);
+    BigInt m61 = (BigInt(1) << 61) - BigInt(1);
+    EXPECT_TRUE(BigInt::isPerfectPower(BigInt::pow(m61, BigInt(5)), &root, &exponent));
+    EXPECT_EQ(root, m61);
+    EXPECT_EQ(exponent, 5);
+    EXPECT_FALSE(BigInt::isPerfectPower(BigInt::pow(m61, BigInt(5)) + BigInt(1)));
+    EXPECT_TRUE(BigInt::isPerfectPower(BigInt(-1), &root, &exponent));
+    EXPECT_EQ(root, BigInt(-1));
+}
+
+TEST_F(BigIntTest, CombinatorialProductsMatchDirectProducts) {
+    BigInt running(1);
+    for (int n = 0; n <= 2000; ++n) {
+        if (n > 0) {
+            running *= n;
+        }
+        if (n <= 300 || n % 97 == 0) {
+            EXPECT_EQ(BigInt::factorial(n), running) << n;
+        }
+    }
+    EXPECT_EQ(BigInt::factorial(25), BigInt("15511210043330985984000000"));
+
+    // Pascal's triangle, one row at a time, including k outside [0, n].
+    std::vector<BigInt> row = {BigInt(1)};
+    for (int n = 0; n <= 120; ++n) {
+        EXPECT_EQ(BigInt::binomial(n, -1), BigInt(0));
+        EXPECT_EQ(BigInt::binomial(n, n + 1), BigInt(0));
+        for (int k = 0; k <= n; ++k) {
+            EXPECT_EQ(BigInt::binomial(n, k), row[k]) << n << " choose " << k;
+        }
+        std::vector<BigInt> next(row.size() + 1, BigInt(1));
+        for (size_t k = 1; k < row.size(); ++k) {
+            next[k] = row[k - 1] + row[k];
+        }
+        row.swap(next);
+    }
+    EXPECT_EQ(BigInt::binomial(100, 50), BigInt("100891344545564193334812497256"));
+    EXPECT_EQ(BigInt::binomial(1000, 300) % BigInt::pow(BigInt(10), BigInt(30)),
+              BigInt("863689773725905288736148678480"));
+
+    for (int n = 0; n <= 200; n += 7) {
+        EXPECT_EQ(BigInt::catalan(n) * BigInt(n + 1), BigInt::binomial(2 * n, n)) << n;
+    }
+    EXPECT_EQ(BigInt::catalan(0), BigInt(1));
+    EXPECT_EQ(BigInt::catalan(30), BigInt(3814986502092304LL));
+
+    EXPECT_THROW(BigInt::factorial(-1), InvalidInputException);
+    EXPECT_THROW(BigInt::binomial(-1, 0), InvalidInputException);
+    EXPECT_THROW(BigInt::catalan(-1), InvalidInputException);
+}
+
+TEST_F(BigIntTest, FibonacciAndLucasMatchTheRecurrence) {
+    BigInt f0(0), f1(1), l0(2), l1(1);
+    for (int n = 0; n <= 500; ++n) {
+        EXPECT_EQ(BigInt::fibonacci(n), f0) << n;
+        EXPECT_EQ(BigInt::lucas(n), l0) << n;
+        auto pair = BigInt::fibonacciPair(n);
+        EXPECT_EQ(pair.first, f0) << n;
+        EXPECT_EQ(pair.second, f1) << n;
+        BigInt f2 = f0 + f1, l2 = l0 + l1;
+        f0 = f1;
+        f1 = f2;
+        l0 = l1;
+        l1 = l2;
+    }
+    EXPECT_EQ(BigInt::fibonacci(300),
+              BigInt("222232244629420445529739893461909967206666939096499764990979600"));
+    EXPECT_EQ(BigInt::lucas(200), BigInt("627376215338105766356982006981782561278127"));
+    BigInt tail = BigInt::pow(BigInt(10), BigInt(30));
+    BigInt f10000 = BigInt::fibonacci(10000);
+    EXPECT_EQ(f10000.getDigitCount(), 2090);
+    EXPECT_EQ(f10000 % tail, BigInt("171121233066073310059947366875"));
+    EXPECT_EQ(BigInt::lucas(10000) % tail, BigInt("988714533655280383362423828127"));
+    // L(n) = F(n - 1) + F(n + 1) and F(2n) = F(n) L(n) on a large index.
+    auto around = BigInt::fibonacciPair(77777);
+    EXPECT_EQ(BigInt::lucas(77777), around.second + around.second - around.first);
+    EXPECT_EQ(BigInt::fibonacci(2 * 77777), around.first * BigInt::lucas(77777));
+
+    EXPECT_THROW(BigInt::fibonacci(-1), InvalidInputException);
+    EXPECT_THROW(BigInt::fibonacciPair(-1), InvalidInputException);
+    EXPECT_THROW(BigInt::lucas(-1), InvalidInputException);
+}
+
+TEST_F(BigIntTest, ModContextMatchesPlainArithmetic) {
+    auto euclidean = [](const BigInt& x, const BigInt& m) {
+        return BigInt::divmod(x, m, BigInt::DivisionMode::Euclidean).second;
+    };
+    // Square-and-multiply on operator%, independent of the context.
+    auto referencePow = [&](const BigInt& base, const BigInt& exponent, const BigInt& m) {
+        BigInt result = euclidean(BigInt(1), m), b = euclidean(base, m);
+        for (size_t bit = exponent.bitLength(); bit-- > 0;) {
+            result = result * result % m;
+            if (exponent.testBit(bit)) {
+                result = result * b % m;
+            }
+        }
+        return result;
+    };
+    const size_t MONTGOMERY_LIMIT = BigInt::ModContext::MONTGOMERY_LIMIT;
+    struct Case {
+        size_t limbs;
+        bool odd;
+        bool montgomery;
+    };
+    const Case cases[] = {{1, true, true}, {1, false, false}, {3, true, true}, {8, false, false},
+                          {MONTGOMERY_LIMIT, true, true}, {MONTGOMERY_LIMIT + 1, true, false}};
+    for (const Case& c : cases) {
+        BigInt m = randomValue(rng, c.limbs);
+        if (m.testBit(0) != c.odd) {
+            m += BigInt(1);
+        }
+        BigInt::ModContext context(m);
+        EXPECT_EQ(context.usesMontgomery(), c.montgomery) << c.limbs;
+        EXPECT_EQ(context.modulus(), m);
+        for (int i = 0; i < 4; ++i) {
+            BigInt a = randomValue(rng, 1 + rng() % (2 * c.limbs), rng() & 1);
+            BigInt b = randomValue(rng, 1 + rng() % c.limbs, rng() & 1);
+            BigInt e = randomValue(rng, 1 + rng() % 2);
+            EXPECT_EQ(context.reduce(a), euclidean(a, m)) << c.limbs;
+            EXPECT_EQ(context.multiply(a, b), euclidean(a * b, m)) << c.limbs;
+            EXPECT_EQ(context.square(a), euclidean(a * a, m)) << c.limbs;
+            EXPECT_EQ(context.modPow(a, e), referencePow(a, e, m)) << c.limbs;
+
+            // Residue chains, with outputs aliasing their inputs.
+            typedef BigInt::ModContext::Residue Residue;
+            Residue ra = context.toResidue(a), rb = context.toResidue(b), r;
+            EXPECT_EQ(context.fromResidue(ra), euclidean(a, m));
+            context.add(r, ra, rb);
+            EXPECT_EQ(context.fromResidue(r), euclidean(a + b, m));
+            context.subtract(r, ra, rb);
+            EXPECT_EQ(context.fromResidue(r), euclidean(a - b, m));
+            context.multiply(r, ra, rb);
+            context.multiply(r, r, r);
+            EXPECT_EQ(context.fromResidue(r), euclidean(a * b * a * b, m));
+            context.add(ra, ra, ra);
+            context.subtract(rb, ra, rb);
+            EXPECT_EQ(context.fromResidue(rb), euclidean(a + a - b, m));
+            context.subtract(ra, ra, ra);
+            EXPECT_TRUE(context.isZero(ra));
+            EXPECT_EQ(context.isZero(context.toResidue(a)), euclidean(a, m).isZero());
+        }
+        EXPECT_TRUE(context.isZero(context.toResidue(m * BigInt(3))));
+        EXPECT_EQ(context.modPow(m - BigInt(1), BigInt(0)), BigInt(1) % m);
+    }
+    BigInt::ModContext small(BigInt(1000000007));
+    EXPECT_EQ(small.modPow(BigInt(2), BigInt(1000000006)), BigInt(1));
+    EXPECT_EQ(small.modPow(BigInt(3), BigInt(12345)), BigInt(964676307));
+    EXPECT_THROW(small.modPow(BigInt(2), BigInt(-1)), InvalidInputException);
+    EXPECT_THROW(BigInt::ModContext(BigInt(0)), InvalidInputException);
+    EXPECT_THROW(BigInt::ModContext(BigInt(-5)), InvalidInputException);
+}
+
+TEST_F(BigIntTest, CharConversionsMatchTheStandardLibrary) {
+    const long long samples[] = {0, 1, -1, 9, 10, -35, 123456789, -(1LL << 62), 9223372036854775807LL};
+    for (long long sample : samples) {
+        for (int base : {2, 8, 10, 16, 36, 7}) {
+            char expected[80], actual[80];
+            std::to_chars_result reference = std::to_chars(expected, expected + sizeof(expected), sample, base);
+            std::to_chars_result result = to_chars(actual, actual + sizeof(actual), BigInt(sample), base);
+            ASSERT_EQ(result.ec, std::errc());
+            EXPECT_EQ(std::string(actual, result.ptr), std::string(expected, reference.ptr))
+                << sample << " in base " << base;
+            BigInt parsed;
+            std::from_chars_result back = from_chars(expected, reference.ptr, parsed, base);
+            EXPECT_EQ(back.ec, std::errc());
+            EXPECT_EQ(back.ptr, reference.ptr);
+            EXPECT_EQ(parsed, BigInt(sample));
+        }
+    }
+
+    // Values past the 64-limb chunk take the divide-and-conquer path; the
+    // decimal reference peels 18 digits at a time by single-limb division.
+    for (size_t n : {1, 10, 64, 65, 400}) {
+        BigInt a = randomValue(rng, n, rng() & 1);
+        std::string expected;
+        BigInt rest = abs(a);
+        while (!rest.isZero()) {
+            BigInt quotient;
+            std::string digits = std::to_string(BigInt::divmodSmall(rest, 1000000000000000000LL, quotient));
+            rest = quotient;
+            expected = (rest.isZero() ? digits : std::string(18 - digits.size(), '0') + digits) + expected;
+        }
+        if (a.isNegative()) {
+            expected = "-" + expected;
+        }
+        std::vector<char> buffer(expected.size() + 1);
+        std::to_chars_result result = to_chars(buffer.data(), buffer.data() + buffer.size(), a);
+        ASSERT_EQ(result.ec, std::errc());
+        EXPECT_EQ(std::string(buffer.data(), result.ptr), expected) << n;
+        result = to_chars(buffer.data(), buffer.data() + expected.size() - 1, a);
+        EXPECT_EQ(result.ec, std::errc::value_too_large);
+        for (int base : {10, 16, 3}) {
+            BigInt parsed;
+            std::string text = a.toString(base) + "!";
+            std::from_chars_result back = from_chars(text.data(), text.data() + text.size(), parsed, base);
+            EXPECT_EQ(back.ec, std::errc());
+            EXPECT_EQ(back.ptr, text.data() + text.size() - 1);
+            EXPECT_EQ(parsed, a) << n << " limbs in base " << base;
+        }
+    }
+
+    BigInt untouched(42);
+    for (const char* text : {"", "-", "+5", "z"}) {
+        std::from_chars_result result = from_chars(text, text + std::strlen(text), untouched);
+        EXPECT_EQ(result.ec, std::errc::invalid_argument) << text;
+        EXPECT_EQ(result.ptr, text);
+        EXPECT_EQ(untouched, BigInt(42));
+    }
+    BigInt value;
+    const char hex[] = "-fFz";
+    std::from_chars_result partial = from_chars(hex, hex + 4, value, 16);
+    EXPECT_EQ(partial.ptr, hex + 3);
+    EXPECT_EQ(value, BigInt(-255));
+    char small[4];
+    EXPECT_THROW(to_chars(small, small + 4, BigInt(5), 37), InvalidInputException);
+    EXPECT_THROW(from_chars(hex, hex + 4, value, 1), InvalidInputException);
+}